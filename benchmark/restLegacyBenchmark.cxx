@@ -0,0 +1,333 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// restLegacyBenchmark measures the throughput of the zero suppression used
+/// to replay TRestRawZeroSuppresionProcess. It sweeps the number of
+/// channels, the number of samples, the noise level and the pulse
+/// occupancy of the events produced by TRestLegacySignalGenerator, and for
+/// each configuration it reports the time per channel, the events per
+/// second and the bytes of ADC samples per second. The speed of the
+/// generator is also reported.
+///
+/// \code
+///     restLegacyBenchmark [--threads N] [--events N] [--time seconds] [--isa scalar|avx2|avx512]
+///                         [--output results.json] [--io "/data/R*.root"]
+/// \endcode
+///
+/// With `--io`, it also measures the time spent reading the
+/// TRestRawZeroSuppresionProcess objects stored in the files matching the
+/// pattern given, separately for each class version found in the files.
+/// Each file is opened once and each object is read once, so that the
+/// first read of each file is measured.
+///
+/// The results can also be written to a JSON file, to track the
+/// performance between releases.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// <hr>
+///
+
+#include <TFile.h>
+#include <TKey.h>
+#include <TRestDetectorSignalEvent.h>
+#include <TRestRawSignalEvent.h>
+#include <TRestTools.h>
+#include <TStreamerInfo.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "TRestLegacySignalGenerator.h"
+#include "TRestRawZeroSuppresionKernel.h"
+#include "TRestRawZeroSuppresionProcess.h"
+#include "TRestRawZeroSuppresionSIMD.h"
+
+namespace {
+
+/// The configuration of the events of one measurement
+struct Configuration {
+    Int_t fNChannels;
+    Int_t fNSamples;
+    Double_t fNoise;
+    Double_t fOccupancy;
+};
+
+/// The result of one measurement
+struct Result {
+    Configuration fConfiguration;
+    Double_t fNsPerChannel;
+    Double_t fEventsPerSecond;
+    Double_t fBytesPerSecond;
+    Double_t fPointsPerEvent;
+};
+
+/// Returns the parameters of the generator producing the events of one configuration
+TRestLegacySignalGenerator::Parameters GetGeneratorParameters(const Configuration& configuration) {
+    TRestLegacySignalGenerator::Parameters parameters;
+    parameters.fNChannels = configuration.fNChannels;
+    parameters.fNSamples = configuration.fNSamples;
+    parameters.fNoise = configuration.fNoise;
+    parameters.fOccupancy = configuration.fOccupancy;
+    parameters.fSeed = 12345;
+    return parameters;
+}
+
+/// It measures the speed of the generator, in bytes of ADC samples per second
+Double_t MeasureGenerator(Double_t minTime) {
+    TRestLegacySignalGenerator generator(GetGeneratorParameters({2048, 512, 10, 0.1}));
+    TRestRawChannelMatrix matrix;
+
+    ULong64_t nEvents = 0;
+    Double_t elapsed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (elapsed < minTime) {
+        generator.Generate(nEvents++, matrix);
+        elapsed = std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+    }
+    return nEvents * 2048. * 512 * sizeof(Short_t) / elapsed;
+}
+
+/// It measures the zero suppression of the events of one configuration during at least `minTime` seconds
+Result Measure(const Configuration& configuration, Int_t nThreads, Int_t nEvents, Double_t minTime) {
+    TRestRawZeroSuppresionKernel::Parameters parameters;
+    parameters.fBaseLineStart = 20;
+    parameters.fBaseLineEnd = 150;
+    parameters.fIntegralStart = 0;
+    parameters.fIntegralEnd = 0;
+    parameters.fPointThreshold = 3;
+    parameters.fSignalThreshold = 5;
+    parameters.fNPointsOverThreshold = 5;
+    parameters.fNPointsFlatThreshold = 4;
+    parameters.fSampling = 0.1;
+
+    TRestLegacySignalGenerator generator(GetGeneratorParameters(configuration));
+    std::vector<TRestRawSignalEvent> inputEvents(nEvents);
+    for (Int_t n = 0; n < nEvents; n++) generator.Generate(n, &inputEvents[n]);
+
+    TRestRawZeroSuppresionKernel kernel(parameters, nThreads);
+    TRestDetectorSignalEvent outputEvent;
+
+    // The first pass prepares the buffers of the kernel, and it is not measured
+    Long64_t nPoints = 0;
+    for (auto& event : inputEvents) kernel.ProcessEvent(&event, &outputEvent);
+
+    Long64_t nProcessed = 0;
+    Double_t elapsed = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (elapsed < minTime) {
+        for (auto& event : inputEvents) {
+            kernel.ProcessEvent(&event, &outputEvent);
+            for (Int_t s = 0; s < outputEvent.GetNumberOfSignals(); s++)
+                nPoints += outputEvent.GetSignal(s)->GetNumberOfPoints();
+        }
+        nProcessed += nEvents;
+        elapsed = std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    Result result;
+    result.fConfiguration = configuration;
+    result.fNsPerChannel = 1e9 * elapsed / ((Double_t)nProcessed * configuration.fNChannels);
+    result.fEventsPerSecond = nProcessed / elapsed;
+    result.fBytesPerSecond =
+        result.fEventsPerSecond * configuration.fNChannels * configuration.fNSamples * sizeof(Short_t);
+    result.fPointsPerEvent = (Double_t)nPoints / nProcessed;
+    return result;
+}
+
+/// The time spent reading the legacy processes written with one class version
+struct IOResult {
+    Long64_t fNObjects = 0;
+    Long64_t fBytes = 0;
+    Double_t fTime = 0;
+};
+
+/// It measures the time spent reading the legacy processes stored in `fileNames`, for each class
+/// version. Each file is opened once and each process is read once, so that the first read of
+/// each file is measured. The class versions without any process read are not returned.
+std::map<Int_t, IOResult> MeasureIO(const std::vector<std::string>& fileNames) {
+    std::map<Int_t, IOResult> results;
+    for (const auto& fileName : fileNames) {
+        std::unique_ptr<TFile> file(TFile::Open(fileName.c_str(), "READ"));
+        if (file == nullptr || file->IsZombie()) continue;
+
+        auto info =
+            (TStreamerInfo*)file->GetStreamerInfoCache()->FindObject("TRestRawZeroSuppresionProcess");
+        if (info == nullptr) continue;
+        const Int_t classVersion = info->GetClassVersion();
+
+        TIter next(file->GetListOfKeys());
+        while (TKey* key = (TKey*)next()) {
+            if (std::string(key->GetClassName()) != "TRestRawZeroSuppresionProcess") continue;
+
+            const auto start = std::chrono::steady_clock::now();
+            delete key->ReadObj();
+            const auto end = std::chrono::steady_clock::now();
+
+            IOResult& result = results[classVersion];
+            result.fTime += std::chrono::duration<Double_t>(end - start).count();
+            result.fNObjects++;
+            result.fBytes += key->GetObjlen();
+        }
+    }
+
+    // The rates are not defined without any time measured
+    for (auto result = results.begin(); result != results.end();)
+        result = result->second.fTime > 0 ? std::next(result) : results.erase(result);
+    return results;
+}
+
+std::string GetInstructionSetName() {
+    return TRestRawZeroSuppresionSIMD::GetInstructionSetName(TRestRawZeroSuppresionSIMD::GetInstructionSet());
+}
+
+void WriteJSON(const std::string& fileName, const std::vector<Result>& results,
+               const std::map<Int_t, IOResult>& ioResults, Int_t nThreads) {
+    std::ofstream file(fileName);
+    file << "{\n";
+    file << "  \"library\": \"legacy\",\n";
+    file << "  \"version\": \"" << LIBRARY_VERSION << "\",\n";
+    file << "  \"instructionSet\": \"" << GetInstructionSetName() << "\",\n";
+    file << "  \"threads\": " << nThreads << ",\n";
+    file << "  \"results\": [\n";
+    for (size_t n = 0; n < results.size(); n++) {
+        const Result& result = results[n];
+        file << "    {\"channels\": " << result.fConfiguration.fNChannels
+             << ", \"samples\": " << result.fConfiguration.fNSamples
+             << ", \"noise\": " << result.fConfiguration.fNoise
+             << ", \"occupancy\": " << result.fConfiguration.fOccupancy
+             << ", \"nsPerChannel\": " << result.fNsPerChannel
+             << ", \"eventsPerSecond\": " << result.fEventsPerSecond
+             << ", \"bytesPerSecond\": " << result.fBytesPerSecond
+             << ", \"pointsPerEvent\": " << result.fPointsPerEvent << "}"
+             << (n + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "  ],\n";
+    file << "  \"io\": [\n";
+    for (auto ioResult = ioResults.begin(); ioResult != ioResults.end(); ioResult++) {
+        const IOResult& result = ioResult->second;
+        file << "    {\"classVersion\": " << ioResult->first << ", \"objects\": " << result.fNObjects
+             << ", \"usPerObject\": " << 1e6 * result.fTime / result.fNObjects
+             << ", \"bytesPerSecond\": " << result.fBytes / result.fTime << "}"
+             << (std::next(ioResult) != ioResults.end() ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+}
+
+void PrintUsage() {
+    std::cout << "Usage: restLegacyBenchmark [--threads N] [--events N] [--time seconds]" << std::endl;
+    std::cout << "                           [--isa scalar|avx2|avx512] [--output results.json]" << std::endl;
+    std::cout << "                           [--io \"/data/R*.root\"]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Int_t nThreads = 1;
+    Int_t nEvents = 16;
+    Double_t minTime = 0.5;
+    std::string output;
+    std::string ioPattern;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            PrintUsage();
+            return 0;
+        }
+        if (i + 1 == argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        if (option == "--threads") {
+            nThreads = std::max(atoi(value.c_str()), 1);
+        } else if (option == "--events") {
+            nEvents = std::max(atoi(value.c_str()), 1);
+        } else if (option == "--time") {
+            minTime = atof(value.c_str());
+        } else if (option == "--output") {
+            output = value;
+        } else if (option == "--io") {
+            ioPattern = value;
+        } else if (option == "--isa") {
+            typedef TRestRawZeroSuppresionSIMD::InstructionSet InstructionSet;
+            if (value == "scalar")
+                TRestRawZeroSuppresionSIMD::SetInstructionSet(InstructionSet::kScalar);
+            else if (value == "avx2")
+                TRestRawZeroSuppresionSIMD::SetInstructionSet(InstructionSet::kAVX2);
+            else if (value != "avx512") {
+                PrintUsage();
+                return 1;
+            }
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    std::cout << "Instruction set : " << GetInstructionSetName() << ", threads : " << nThreads << std::endl;
+    std::cout << "Generator : " << MeasureGenerator(minTime) / 1e6 << " MB/s" << std::endl;
+    std::cout << "channels  samples  noise  occupancy    ns/channel      events/s        MB/s" << std::endl;
+
+    std::vector<Result> results;
+    for (const Int_t nChannels : {256, 2048})
+        for (const Int_t nSamples : {256, 512, 1024})
+            for (const Double_t noise : {2., 10.})
+                for (const Double_t occupancy : {0.01, 0.1, 0.5}) {
+                    const Result result =
+                        Measure({nChannels, nSamples, noise, occupancy}, nThreads, nEvents, minTime);
+                    results.push_back(result);
+
+                    printf("%8d  %7d  %5.1f  %9.2f  %12.1f  %12.1f  %10.1f\n", nChannels, nSamples, noise,
+                           occupancy, result.fNsPerChannel, result.fEventsPerSecond,
+                           result.fBytesPerSecond / 1e6);
+                }
+
+    std::map<Int_t, IOResult> ioResults;
+    if (!ioPattern.empty()) {
+        ioResults = MeasureIO(TRestTools::GetFilesMatchingPattern(ioPattern));
+        std::cout << "classVersion   objects    us/object        MB/s" << std::endl;
+        for (const auto& ioResult : ioResults) {
+            const IOResult& result = ioResult.second;
+            printf("%12d  %8lld  %11.2f  %10.1f\n", ioResult.first, result.fNObjects,
+                   1e6 * result.fTime / result.fNObjects, result.fBytes / result.fTime / 1e6);
+        }
+    }
+
+    if (!output.empty()) WriteJSON(output, results, ioResults, nThreads);
+    return 0;
+}
@@ -0,0 +1,277 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// restLegacyStartupBenchmark measures the time that the legacy library
+/// adds to the startup of a program. It is not linked to the library, it
+/// loads it at run time, and it measures each step separately:
+///
+/// - The loading of the library, including the registration of its
+///   dictionaries, done by the static initialization of the library.
+/// - The first TClass lookup of each legacy class.
+/// - The first instantiation of each legacy class.
+///
+/// The lookups and the instantiations are measured twice, cold when they
+/// are done for the first time and warm when they are repeated. For each
+/// step, it reports the wall time, the page faults and the increase of the
+/// resident memory.
+///
+/// \code
+///     restLegacyStartupBenchmark [--repetitions N] [--library libRestLegacy] [--output results.json]
+/// \endcode
+///
+/// Each repetition is done in a new process, forked before the library is
+/// loaded, so that every repetition loads the library cold. The median of
+/// the repetitions is reported.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// <hr>
+///
+
+#include <TClass.h>
+#include <TSystem.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "TRestLegacyRegistry.h"
+
+namespace {
+
+/// The cost of one step
+struct Measurement {
+    Double_t fTime = 0;
+    Long64_t fPageFaults = 0;
+    Long64_t fRSSDelta = 0;
+};
+
+/// The state of the process used to measure a step
+struct Usage {
+    std::chrono::steady_clock::time_point fTime;
+    Long64_t fPageFaults;
+    Long64_t fRSS;
+};
+
+/// Returns the resident memory of this process, in bytes, or 0 if it is not available
+Long64_t GetRSS() {
+    long size = 0;
+    long resident = 0;
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if (statm == nullptr) return 0;
+    if (fscanf(statm, "%ld %ld", &size, &resident) != 2) resident = 0;
+    fclose(statm);
+    return (Long64_t)resident * sysconf(_SC_PAGESIZE);
+}
+
+Usage GetUsage() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return {std::chrono::steady_clock::now(), (Long64_t)(usage.ru_minflt + usage.ru_majflt), GetRSS()};
+}
+
+Measurement GetMeasurement(const Usage& start) {
+    const Usage end = GetUsage();
+    Measurement measurement;
+    measurement.fTime = std::chrono::duration<Double_t>(end.fTime - start.fTime).count();
+    measurement.fPageFaults = end.fPageFaults - start.fPageFaults;
+    measurement.fRSSDelta = end.fRSS - start.fRSS;
+    return measurement;
+}
+
+/// Returns the legacy classes measured, the base class and every legacy process with a replacement
+std::vector<std::string> GetLegacyClasses() {
+    std::vector<std::string> classes = {"TRestLegacyProcess"};
+    for (const auto& replacement : TRestLegacyRegistry::kReplacements)
+        classes.push_back(replacement.fLegacyClass);
+    return classes;
+}
+
+/// Returns the names of the steps measured, in the order they are measured
+std::vector<std::string> GetSteps() {
+    std::vector<std::string> steps = {"load"};
+    for (const std::string mode : {"cold", "warm"})
+        for (const auto& className : GetLegacyClasses()) {
+            steps.push_back("TClass lookup " + mode + " " + className);
+            steps.push_back("instantiation " + mode + " " + className);
+        }
+    return steps;
+}
+
+/// It measures all the steps in this process. The library must not be loaded yet.
+std::vector<Measurement> MeasureSteps(const std::string& library) {
+    std::vector<Measurement> measurements;
+
+    Usage start = GetUsage();
+    if (gSystem->Load(library.c_str()) < 0) return {};
+    measurements.push_back(GetMeasurement(start));
+
+    for (Int_t repetition = 0; repetition < 2; repetition++)
+        for (const auto& className : GetLegacyClasses()) {
+            start = GetUsage();
+            TClass* legacyClass = TClass::GetClass(className.c_str());
+            measurements.push_back(GetMeasurement(start));
+
+            start = GetUsage();
+            void* object = legacyClass == nullptr ? nullptr : legacyClass->New();
+            measurements.push_back(GetMeasurement(start));
+            if (object != nullptr) legacyClass->Destructor(object);
+        }
+    return measurements;
+}
+
+/// It measures all the steps in a new process. It returns an empty list if the measurement failed.
+std::vector<Measurement> MeasureInChild(const std::string& library, size_t nSteps) {
+    int channel[2];
+    if (pipe(channel) != 0) return {};
+
+    const pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        const std::vector<Measurement> measurements = MeasureSteps(library);
+        const ssize_t size = measurements.size() * sizeof(Measurement);
+        const Bool_t written = write(channel[1], measurements.data(), size) == size;
+        close(channel[1]);
+        _exit(written && !measurements.empty() ? 0 : 1);
+    }
+
+    close(channel[1]);
+    std::vector<Measurement> measurements(nSteps);
+    const ssize_t size = nSteps * sizeof(Measurement);
+    ssize_t received = 0;
+    while (child > 0 && received < size) {
+        const ssize_t n = read(channel[0], (char*)measurements.data() + received, size - received);
+        if (n <= 0) break;
+        received += n;
+    }
+    close(channel[0]);
+
+    int status = 0;
+    if (child > 0) waitpid(child, &status, 0);
+    if (child <= 0 || received != size || !WIFEXITED(status) || WEXITSTATUS(status) != 0) return {};
+    return measurements;
+}
+
+/// Returns the median of the measurements of one step, taking the median of each quantity
+Measurement GetMedian(const std::vector<std::vector<Measurement>>& repetitions, size_t step) {
+    std::vector<Double_t> times;
+    std::vector<Long64_t> pageFaults;
+    std::vector<Long64_t> rssDeltas;
+    for (const auto& measurements : repetitions) {
+        times.push_back(measurements[step].fTime);
+        pageFaults.push_back(measurements[step].fPageFaults);
+        rssDeltas.push_back(measurements[step].fRSSDelta);
+    }
+    const size_t middle = repetitions.size() / 2;
+    std::nth_element(times.begin(), times.begin() + middle, times.end());
+    std::nth_element(pageFaults.begin(), pageFaults.begin() + middle, pageFaults.end());
+    std::nth_element(rssDeltas.begin(), rssDeltas.begin() + middle, rssDeltas.end());
+    return {times[middle], pageFaults[middle], rssDeltas[middle]};
+}
+
+void WriteJSON(const std::string& fileName, const std::vector<std::string>& steps,
+               const std::vector<Measurement>& results, Int_t nRepetitions) {
+    std::ofstream file(fileName);
+    file << "{\n";
+    file << "  \"library\": \"legacy\",\n";
+    file << "  \"version\": \"" << LIBRARY_VERSION << "\",\n";
+    file << "  \"repetitions\": " << nRepetitions << ",\n";
+    file << "  \"steps\": [\n";
+    for (size_t n = 0; n < steps.size(); n++) {
+        file << "    {\"step\": \"" << steps[n] << "\", \"seconds\": " << results[n].fTime
+             << ", \"pageFaults\": " << results[n].fPageFaults << ", \"rssDelta\": " << results[n].fRSSDelta
+             << "}" << (n + 1 < steps.size() ? ",\n" : "\n");
+    }
+    file << "  ]\n";
+    file << "}\n";
+}
+
+void PrintUsage() {
+    std::cout << "Usage: restLegacyStartupBenchmark [--repetitions N] [--library libRestLegacy]" << std::endl;
+    std::cout << "                                  [--output results.json]" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Int_t nRepetitions = 10;
+    std::string library = "libRestLegacy";
+    std::string output;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string option = argv[i];
+        if (option == "--help" || option == "-h") {
+            PrintUsage();
+            return 0;
+        }
+        if (i + 1 == argc) {
+            PrintUsage();
+            return 1;
+        }
+
+        const std::string value = argv[++i];
+        if (option == "--repetitions") {
+            nRepetitions = std::max(atoi(value.c_str()), 1);
+        } else if (option == "--library") {
+            library = value;
+        } else if (option == "--output") {
+            output = value;
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    const std::vector<std::string> steps = GetSteps();
+    std::vector<std::vector<Measurement>> repetitions;
+    for (Int_t n = 0; n < nRepetitions; n++) {
+        std::vector<Measurement> measurements = MeasureInChild(library, steps.size());
+        if (measurements.empty()) {
+            std::cout << "The library " << library << " could not be measured" << std::endl;
+            return 1;
+        }
+        repetitions.push_back(measurements);
+    }
+
+    std::vector<Measurement> results;
+    std::cout << "Median of " << nRepetitions << " repetitions" << std::endl;
+    printf("%-60s  %10s  %11s  %13s\n", "step", "ms", "page faults", "RSS delta kB");
+    for (size_t n = 0; n < steps.size(); n++) {
+        results.push_back(GetMedian(repetitions, n));
+        printf("%-60s  %10.3f  %11lld  %13lld\n", steps[n].c_str(), 1e3 * results[n].fTime,
+               results[n].fPageFaults, results[n].fRSSDelta / 1024);
+    }
+
+    if (!output.empty()) WriteJSON(output, steps, results, nRepetitions);
+    return 0;
+}
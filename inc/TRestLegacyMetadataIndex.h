@@ -0,0 +1,103 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyMetadataIndex
+#define RestCore_TRestLegacyMetadataIndex
+
+#include <Rtypes.h>
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//! A sidecar file with the TRestRawZeroSuppresionProcess parameters of many run files, read through mmap
+class TRestLegacyMetadataIndex {
+   public:
+    /// The parameters of one TRestRawZeroSuppresionProcess, as stored in the index file
+    struct Record {
+        /// The fingerprint of the run file storing the process, see Hash
+        ULong64_t fHash;
+
+        /// The version of TRestRawZeroSuppresionProcess used to write the run file
+        Int_t fClassVersion;
+
+        Int_t fNPointsOverThreshold;
+        Int_t fNPointsFlatThreshold;
+
+        /// The hash of the name of the key storing the process in the run file, see HashName
+        UInt_t fNameHash;
+
+        Double_t fBaseLineStart;
+        Double_t fBaseLineEnd;
+        Double_t fIntegralStart;
+        Double_t fIntegralEnd;
+        Double_t fPointThreshold;
+        Double_t fSignalThreshold;
+        Double_t fSampling;
+    };
+
+    /// The beginning of the index file, followed by the records sorted by fHash
+    struct Header {
+        char fMagic[8];
+        UInt_t fVersion;
+        UInt_t fRecordSize;
+        ULong64_t fNRecords;
+    };
+
+    /// The version of the index file format
+    static constexpr UInt_t kVersion = 2;
+
+   private:
+    /// The mapped index file, or nullptr if it could not be opened
+    const char* fData = nullptr;
+
+    /// The size of the mapped index file
+    size_t fSize = 0;
+
+    /// The records of the index file, inside the mapped memory
+    const Record* fRecords = nullptr;
+    size_t fNRecords = 0;
+
+   public:
+    static ULong64_t Hash(const std::string& runFile);
+    static UInt_t HashName(const std::string& name);
+
+    static Bool_t Build(const std::string& indexFile, const std::vector<std::string>& runFiles,
+                        Int_t nThreads = 0);
+
+    std::vector<Record> Lookup(ULong64_t hash) const;
+    std::vector<Record> Lookup(const std::string& runFile) const;
+    std::vector<Record> Lookup(const std::string& runFile, const std::string& name) const;
+
+    /// Returns true if the index file was opened
+    Bool_t IsOpen() const { return fData != nullptr; }
+
+    /// Returns the number of records in the index file
+    size_t GetNumberOfRecords() const { return fNRecords; }
+
+    explicit TRestLegacyMetadataIndex(const std::string& indexFile);
+    ~TRestLegacyMetadataIndex();
+
+    TRestLegacyMetadataIndex(const TRestLegacyMetadataIndex&) = delete;
+    TRestLegacyMetadataIndex& operator=(const TRestLegacyMetadataIndex&) = delete;
+};
+#endif
@@ -0,0 +1,101 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyMetadataScanner
+#define RestCore_TRestLegacyMetadataScanner
+
+#include <Rtypes.h>
+#include <TVector2.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+class TRestRawZeroSuppresionProcess;
+
+//! It reads the TRestRawZeroSuppresionProcess parameters stored in many run files concurrently
+class TRestLegacyMetadataScanner {
+   public:
+    /// The parameters of one TRestRawZeroSuppresionProcess found in a run file
+    struct Entry {
+        std::string fFileName;
+
+        /// The name of the key storing the process. Empty if the file could not be read.
+        std::string fName;
+
+        /// The version of TRestRawZeroSuppresionProcess used to write the file
+        Int_t fClassVersion = 0;
+
+        TVector2 fBaseLineRange;
+        TVector2 fIntegralRange;
+        Double_t fPointThreshold = 0;
+        Double_t fSignalThreshold = 0;
+        Int_t fNPointsOverThreshold = 0;
+        Int_t fNPointsFlatThreshold = 0;
+        Double_t fSampling = 0;
+
+        /// The reason why the file or the process could not be read, empty if it was read
+        std::string fError;
+    };
+
+   private:
+    /// The number of files opened at the same time
+    Int_t fNThreads;
+
+    /// The processes found by the last scan, in the order of the files given
+    std::vector<Entry> fEntries;
+
+    /// The number of files scanned, and the ones that could not be read
+    Int_t fNFiles = 0;
+    Int_t fNFailedFiles = 0;
+
+    /// The time spent by the last scan, in seconds
+    Double_t fTime = 0;
+
+    static void ScanFile(const std::string& fileName, std::vector<Entry>& entries);
+
+   public:
+    static void FillParameters(const TRestRawZeroSuppresionProcess& process, Entry& entry);
+    static std::string QuoteField(const std::string& field);
+
+    void Scan(const std::vector<std::string>& fileNames);
+
+    /// Returns the processes found by the last scan
+    const std::vector<Entry>& GetEntries() const { return fEntries; }
+
+    /// Returns the number of files scanned
+    Int_t GetNumberOfFiles() const { return fNFiles; }
+
+    /// Returns the number of files that could not be read
+    Int_t GetNumberOfFailedFiles() const { return fNFailedFiles; }
+
+    /// Returns the time spent by the last scan, in seconds
+    Double_t GetTime() const { return fTime; }
+
+    /// Returns the number of files opened at the same time
+    Int_t GetNumberOfThreads() const { return fNThreads; }
+
+    void WriteTable(std::ostream& output, char separator = ',') const;
+
+    explicit TRestLegacyMetadataScanner(Int_t nThreads = 0);
+};
+#endif
@@ -0,0 +1,83 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyMigration
+#define RestCore_TRestLegacyMigration
+
+#include <Rtypes.h>
+
+#include <string>
+#include <vector>
+
+#include "TRestLegacyMetadataScanner.h"
+
+class TRestEventProcess;
+
+//! It converts the TRestRawZeroSuppresionProcess of many run files to TRestRawToDetectorSignalProcess configs
+class TRestLegacyMigration {
+   public:
+    /// The configuration assigned to one process found in a run file
+    struct Mapping {
+        std::string fFileName;
+
+        /// The name of the key storing the legacy process
+        std::string fName;
+
+        /// The name of the equivalent TRestRawToDetectorSignalProcess section, empty if it could not be read
+        std::string fConfigName;
+
+        /// The reason why the file or the process could not be read, empty if it was read
+        std::string fError;
+    };
+
+   private:
+    /// The number of files opened at the same time
+    Int_t fNThreads;
+
+    /// The processes found by the last migration, in the order of the files given
+    std::vector<Mapping> fMappings;
+
+    /// The distinct sections produced by the last migration, and their names
+    std::vector<std::string> fConfigNames;
+    std::vector<std::string> fConfigs;
+
+   public:
+    static std::string GetModernSection(const TRestLegacyMetadataScanner::Entry& parameters,
+                                        const std::string& name, const std::string& verboseLevel = "");
+    static TRestEventProcess* CreateModernProcess(const TRestLegacyMetadataScanner::Entry& parameters,
+                                                  const std::string& name,
+                                                  const std::string& verboseLevel = "");
+
+    static Int_t Rewrite(const std::string& fileName);
+
+    void Migrate(const std::vector<std::string>& fileNames);
+    Bool_t Write(const std::string& outputDirectory) const;
+
+    /// Returns the configuration assigned to each process found by the last migration
+    const std::vector<Mapping>& GetMappings() const { return fMappings; }
+
+    /// Returns the number of distinct configurations produced by the last migration
+    size_t GetNumberOfConfigs() const { return fConfigs.size(); }
+
+    explicit TRestLegacyMigration(Int_t nThreads = 0) : fNThreads(nThreads) {}
+};
+#endif
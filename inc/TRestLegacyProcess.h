@@ -23,22 +23,70 @@
 #ifndef RestCore_TRestLegacyProcess
 #define RestCore_TRestLegacyProcess
 
+#include <map>
+#include <string>
+
 #include "TRestEventProcess.h"
 
 //! Base class for legacy process
 class TRestLegacyProcess : public TRestEventProcess {
+   private:
+    /// It enables the replay of the legacy processes implementing it. Disabled by default.
+    static Bool_t fReplayMode;  //!
+
+    /// The number of threads used by a replayed process to share the work of each event
+    static Int_t fReplayThreads;  //!
+
+   public:
+    /// The usage of one legacy class, see GetCounters
+    struct Counters;
+
+    /// The usage of one legacy class, as returned by GetMetrics
+    struct Metrics {
+        /// The number of instances created
+        Long64_t fInstances = 0;
+
+        /// The number of objects read from files, their uncompressed size and the time spent, in seconds
+        Long64_t fReads = 0;
+        Long64_t fBytesRead = 0;
+        Double_t fReadTime = 0;
+    };
+
+   protected:
+    static Counters& GetCounters(const std::string& className);
+    static Bool_t CountInstance(Counters& counters);
+    static void CountRead(Counters& counters, Long64_t bytes, Long64_t nanoseconds);
+
    public:
-    any GetInputEvent() const final { return any((TRestEvent*)nullptr); }
-    any GetOutputEvent() const final { return any((TRestEvent*)nullptr); }
+    any GetInputEvent() const override { return any((TRestEvent*)nullptr); }
+    any GetOutputEvent() const override { return any((TRestEvent*)nullptr); }
 
-    void InitProcess() final{};
-    TRestEvent* ProcessEvent(TRestEvent* eventInput) final {
+    void InitProcess() override{};
+    TRestEvent* ProcessEvent(TRestEvent* eventInput) override {
         RESTError << "You are trying to execute a legacy process" << RESTendl;
         RESTError << "This is not allow, this class is kept for backward compatibility" << RESTendl;
         exit(1);
         return nullptr;
     }
-    void EndProcess() final{};
+    void EndProcess() override{};
+
+    /// It enables or disables the replay of legacy processes using their persisted parameters
+    static void SetReplayMode(Bool_t enable) { fReplayMode = enable; }
+
+    /// Returns true if legacy processes implementing a replay are allowed to run
+    static Bool_t IsReplayMode() { return fReplayMode; }
+
+    /// It sets the number of threads used by a replayed process to share the work of each event
+    static void SetReplayThreads(Int_t nThreads) { fReplayThreads = nThreads; }
+
+    /// Returns the number of threads used by a replayed process to share the work of each event
+    static Int_t GetReplayThreads() { return fReplayThreads; }
+
+    static std::map<std::string, Long64_t> GetInstanceCounts();
+    static void PrintInstanceSummary();
+
+    static std::map<std::string, Metrics> GetMetrics();
+    static Bool_t WriteMetrics(const std::string& fileName, const std::string& format = "json");
 
     /// It prints out the process parameters stored in the metadata structure
     void PrintMetadata() override {}
@@ -48,6 +96,9 @@ class TRestLegacyProcess : public TRestEventProcess {
 
     TRestLegacyProcess() {}
     TRestLegacyProcess(char* cfgFileName) {}
+
+    /// The constructor used by ROOT I/O when a legacy process is read from a file
+    TRestLegacyProcess(TRootIOCtor*) {}
     ~TRestLegacyProcess() {}
 
     ClassDefOverride(TRestLegacyProcess, 0);
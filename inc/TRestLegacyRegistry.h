@@ -0,0 +1,166 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyRegistry
+#define RestCore_TRestLegacyRegistry
+
+#include <Rtypes.h>
+
+#include <string_view>
+
+//! A compile-time table of the legacy processes and the modern processes replacing them
+class TRestLegacyRegistry {
+   public:
+    /// A persisted member of a legacy process and the modern parameter with the same meaning
+    struct Parameter {
+        const char* fLegacyMember;
+
+        /// The name of the modern parameter, or nullptr if it has no equivalent
+        const char* fModernName;
+    };
+
+    /// A modern parameter that takes a fixed value when a legacy process is replaced
+    struct Setting {
+        const char* fName;
+        const char* fValue;
+    };
+
+    /// A legacy process and its replacement
+    struct Replacement {
+        const char* fLegacyClass;
+        const char* fModernClass;
+        const Parameter* fParameters;
+        Int_t fNParameters;
+        const Setting* fSettings;
+        Int_t fNSettings;
+    };
+
+   private:
+    static constexpr Parameter kZeroSuppresionParameters[] = {
+        {"fBaseLineRange", "baseLineRange"},
+        {"fIntegralRange", "integralRange"},
+        {"fPointThreshold", "pointThreshold"},
+        {"fSignalThreshold", "signalThreshold"},
+        {"fNPointsOverThreshold", "nPointsOverThreshold"},
+        {"fNPointsFlatThreshold", "nPointsFlatThreshold"},
+        {"fBaseLineCorrection", nullptr},
+        {"fSampling", "sampling"}};
+
+    static constexpr Setting kZeroSuppresionSettings[] = {{"zeroSuppression", "true"}};
+
+   public:
+    /// The replacement of each legacy process. A new legacy process must be added here.
+    static constexpr Replacement kReplacements[] = {
+        {"TRestRawZeroSuppresionProcess", "TRestRawToDetectorSignalProcess", kZeroSuppresionParameters,
+         sizeof(kZeroSuppresionParameters) / sizeof(Parameter), kZeroSuppresionSettings,
+         sizeof(kZeroSuppresionSettings) / sizeof(Setting)}};
+
+    static constexpr Int_t kNReplacements = sizeof(kReplacements) / sizeof(Replacement);
+
+    /// The number of slots of the hash table, a power of two larger than twice the replacements
+    static constexpr Int_t kTableSize = 8;
+
+    static constexpr ULong64_t Hash(std::string_view name);
+    static constexpr const Replacement* Find(std::string_view legacyClass);
+    static constexpr const char* GetModernClass(std::string_view legacyClass);
+    static constexpr const char* GetModernParameter(std::string_view legacyClass,
+                                                    std::string_view legacyMember);
+
+   private:
+    /// The open addressing hash table with the index of each replacement, -1 for the empty slots
+    struct Table {
+        Int_t fIndex[kTableSize];
+    };
+
+    static constexpr Table BuildTable();
+    static const Table kTable;
+};
+
+///////////////////////////////////////////////
+/// \brief Returns the 64 bit FNV-1a hash of `name`.
+///
+constexpr ULong64_t TRestLegacyRegistry::Hash(std::string_view name) {
+    ULong64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : name) hash = (hash ^ (unsigned char)c) * 0x100000001b3ULL;
+    return hash;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the hash table of kReplacements, built at compile time.
+///
+constexpr TRestLegacyRegistry::Table TRestLegacyRegistry::BuildTable() {
+    static_assert((kTableSize & (kTableSize - 1)) == 0, "The table size must be a power of two");
+    static_assert(2 * kNReplacements <= kTableSize, "The table of legacy replacements is too small");
+
+    Table table{};
+    for (Int_t slot = 0; slot < kTableSize; slot++) table.fIndex[slot] = -1;
+    for (Int_t n = 0; n < kNReplacements; n++) {
+        Int_t slot = Hash(kReplacements[n].fLegacyClass) & (kTableSize - 1);
+        while (table.fIndex[slot] >= 0) slot = (slot + 1) & (kTableSize - 1);
+        table.fIndex[slot] = n;
+    }
+    return table;
+}
+
+inline constexpr TRestLegacyRegistry::Table TRestLegacyRegistry::kTable = TRestLegacyRegistry::BuildTable();
+
+///////////////////////////////////////////////
+/// \brief Returns the replacement of the legacy process `legacyClass`, or
+/// nullptr if it is not a legacy process. It can be evaluated at compile time.
+///
+constexpr const TRestLegacyRegistry::Replacement* TRestLegacyRegistry::Find(std::string_view legacyClass) {
+    Int_t slot = Hash(legacyClass) & (kTableSize - 1);
+    while (kTable.fIndex[slot] >= 0) {
+        const Replacement& replacement = kReplacements[kTable.fIndex[slot]];
+        if (legacyClass == replacement.fLegacyClass) return &replacement;
+        slot = (slot + 1) & (kTableSize - 1);
+    }
+    return nullptr;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the name of the modern process replacing `legacyClass`, or
+/// nullptr if it is not a legacy process.
+///
+constexpr const char* TRestLegacyRegistry::GetModernClass(std::string_view legacyClass) {
+    const Replacement* replacement = Find(legacyClass);
+    return replacement == nullptr ? nullptr : replacement->fModernClass;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the name of the modern parameter equivalent to the member
+/// `legacyMember` of the legacy process `legacyClass`, or nullptr if there is
+/// no equivalent.
+///
+constexpr const char* TRestLegacyRegistry::GetModernParameter(std::string_view legacyClass,
+                                                              std::string_view legacyMember) {
+    const Replacement* replacement = Find(legacyClass);
+    if (replacement == nullptr) return nullptr;
+    for (Int_t n = 0; n < replacement->fNParameters; n++)
+        if (legacyMember == replacement->fParameters[n].fLegacyMember)
+            return replacement->fParameters[n].fModernName;
+    return nullptr;
+}
+
+static_assert(TRestLegacyRegistry::Find("TRestRawZeroSuppresionProcess") != nullptr,
+              "TRestRawZeroSuppresionProcess must have a replacement");
+#endif
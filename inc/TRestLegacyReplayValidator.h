@@ -0,0 +1,104 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyReplayValidator
+#define RestCore_TRestLegacyReplayValidator
+
+#include <string>
+
+#include "TRestDetectorSignalEvent.h"
+#include "TRestRawSignalEvent.h"
+
+class TRestRawToDetectorSignalProcess;
+class TRestRawZeroSuppresionProcess;
+
+//! It compares the replay of TRestRawZeroSuppresionProcess with TRestRawToDetectorSignalProcess
+class TRestLegacyReplayValidator {
+   public:
+    /// The result of the comparison of both processes over the events validated so far
+    struct Report {
+        Long64_t fNEvents = 0;
+        Long64_t fNEventsWithDifferences = 0;
+
+        /// The signals and the points found by the legacy replay
+        Long64_t fNSignals = 0;
+        Long64_t fNPoints = 0;
+
+        /// The signals only found by the legacy replay, or only by the modern process
+        Long64_t fNMissingSignals = 0;
+        Long64_t fNExtraSignals = 0;
+
+        /// The signals found by both, but with a different number of points
+        Long64_t fNDifferentSignals = 0;
+
+        /// The points found by both, whose time or amplitude differ more than the tolerance
+        Long64_t fNDifferentPoints = 0;
+
+        Double_t fMaxTimeDifference = 0;
+        Double_t fMaxAmplitudeDifference = 0;
+
+        /// The time spent by each process, in seconds
+        Double_t fLegacyTime = 0;
+        Double_t fModernTime = 0;
+    };
+
+   private:
+    /// The legacy process whose persisted parameters are replayed
+    TRestRawZeroSuppresionProcess* fLegacyProcess;
+
+    /// The TRestRawToDetectorSignalProcess configured with the equivalent parameters
+    TRestRawToDetectorSignalProcess* fModernProcess = nullptr;
+
+    /// The output of the legacy replay
+    TRestDetectorSignalEvent fLegacyEvent;
+
+    /// The largest difference allowed between the times or the amplitudes of two points
+    Double_t fTolerance;
+
+    Report fReport;
+
+    Bool_t Compare(const TRestDetectorSignalEvent& legacyEvent, TRestDetectorSignalEvent* modernEvent);
+
+   public:
+    std::string GetModernConfig() const;
+
+    Bool_t Validate(TRestRawSignalEvent* rawEvent);
+    void ValidateSynthetic(Int_t nEvents, Int_t nChannels = 512, Int_t nSamples = 512, ULong64_t seed = 1);
+
+    /// Returns the comparison of the events validated so far
+    const Report& GetReport() const { return fReport; }
+
+    /// It restarts the comparison
+    void ResetReport() { fReport = Report(); }
+
+    void PrintReport() const;
+
+    /// Returns the TRestRawToDetectorSignalProcess used for the comparison
+    TRestRawToDetectorSignalProcess* GetModernProcess() const { return fModernProcess; }
+
+    TRestLegacyReplayValidator(TRestRawZeroSuppresionProcess* legacyProcess, Double_t tolerance = 1e-3);
+    ~TRestLegacyReplayValidator();
+
+    TRestLegacyReplayValidator(const TRestLegacyReplayValidator&) = delete;
+    TRestLegacyReplayValidator& operator=(const TRestLegacyReplayValidator&) = delete;
+};
+#endif
@@ -23,7 +23,11 @@
 #ifndef RestCore_TRestRawZeroSuppresionProcess
 #define RestCore_TRestRawZeroSuppresionProcess
 
+#include "TRestDetectorSignalEvent.h"
 #include "TRestLegacyProcess.h"
+#include "TRestRawSignalEvent.h"
+
+class TRestRawZeroSuppresionKernel;
 
 //! A process to identify signal and remove baseline noise from a TRestRawSignalEvent.
 class TRestRawZeroSuppresionProcess : public TRestLegacyProcess {
@@ -52,7 +56,52 @@ class TRestRawZeroSuppresionProcess : public TRestLegacyProcess {
     /// Given in us.
     Double_t fSampling;
 
+    /// A pointer to the specific TRestRawSignalEvent input, only used in replay mode
+    TRestRawSignalEvent* fRawSignalEvent = nullptr;  //!
+
+    /// A pointer to the specific TRestDetectorSignalEvent output, only used in replay mode
+    TRestDetectorSignalEvent* fSignalEvent = nullptr;  //!
+
+    /// The zero suppression kernel configured with the persisted parameters
+    TRestRawZeroSuppresionKernel* fKernel = nullptr;  //!
+
+    void InitKernel();
+    void RegisterInstance();
+
    public:
+    any GetInputEvent() const override;
+    any GetOutputEvent() const override;
+
+    void Initialize() override;
+
+    void InitProcess() override;
+    TRestEvent* ProcessEvent(TRestEvent* eventInput) override;
+
+    void Replay(TRestRawSignalEvent* inputEvent, TRestDetectorSignalEvent* outputEvent);
+    void ReplayBatch(const std::vector<TRestRawSignalEvent*>& inputEvents,
+                     const std::vector<TRestDetectorSignalEvent*>& outputEvents);
+
+    /// Returns the bin range used for the baseline calculation
+    TVector2 GetBaseLineRange() const { return fBaseLineRange; }
+
+    /// Returns the bin range where the points over threshold are identified
+    TVector2 GetIntegralRange() const { return fIntegralRange; }
+
+    /// Returns the number of sigmas over the baseline fluctuation of a point over threshold
+    Double_t GetPointThreshold() const { return fPointThreshold; }
+
+    /// Returns the number of sigmas of the standard deviation of an accepted signal
+    Double_t GetSignalThreshold() const { return fSignalThreshold; }
+
+    /// Returns the number of consecutive points over threshold required to accept a signal
+    Int_t GetNPointsOverThreshold() const { return fNPointsOverThreshold; }
+
+    /// Returns the number of flat points after which a signal tail is ended
+    Int_t GetNPointsFlatThreshold() const { return fNPointsFlatThreshold; }
+
+    /// Returns the ADC sampling, in us
+    Double_t GetSampling() const { return fSampling; }
+
     /// It prints out the process parameters stored in the metadata structure
     void PrintMetadata() override {
         BeginPrintProcess();
@@ -72,14 +121,19 @@ class TRestRawZeroSuppresionProcess : public TRestLegacyProcess {
     }
 
     TRestRawZeroSuppresionProcess() {
-        RESTWarning << "Creating legacy process TRestRawZeroSuppresionProcess" << RESTendl;
-        RESTWarning << "This process is now implemented under TRestRawToDetectorSignalProcess" << RESTendl;
+        RegisterInstance();
+        Initialize();
     }
     TRestRawZeroSuppresionProcess(char* cfgFileName) {
-        RESTWarning << "Creating legacy process TRestRawZeroSuppresionProcess" << RESTendl;
-        RESTWarning << "This process is now implemented under TRestRawToDetectorSignalProcess" << RESTendl;
+        RegisterInstance();
+        Initialize();
     }
 
+    /// The constructor used by ROOT I/O. The persisted parameters are read right after, and the
+    /// process is initialized by InitProcess, so it does not initialize anything.
+    TRestRawZeroSuppresionProcess(TRootIOCtor* ioCtor) : TRestLegacyProcess(ioCtor) { RegisterInstance(); }
+    ~TRestRawZeroSuppresionProcess();
+
     ClassDefOverride(TRestRawZeroSuppresionProcess, 4);
 };
 #endif
@@ -0,0 +1,117 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyArena is a bump allocator for small trivially copyable
+/// objects, as the points produced by TRestRawZeroSuppresionKernel. Each
+/// allocation just advances a pointer inside the current block of memory,
+/// and all the allocations are released at once by Reset, that takes
+/// constant time. The blocks are kept after a reset, so that an arena used
+/// for a sequence of similar events stops allocating memory after the
+/// first ones.
+///
+/// An arena is not thread safe, each thread must use its own arena.
+///
+/// The last allocation can be extended with Grow. It is extended in place
+/// while the current block has enough room, otherwise it is moved to a new
+/// block, leaving the previous copy unused until the next reset.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyArena
+///
+/// <hr>
+///
+
+#include "TRestLegacyArena.h"
+
+#include <algorithm>
+#include <cstring>
+
+///////////////////////////////////////////////
+/// \brief It moves to the next block, with room for at least `bytes` bytes,
+/// and it returns its beginning.
+///
+void* TRestLegacyArena::NextBlock(size_t bytes) {
+    if (!fBlocks.empty()) fCurrent++;
+
+    if (fCurrent == fBlocks.size() || fBlocks[fCurrent].fSize < bytes) {
+        const size_t size = std::max(bytes, fBlockSize);
+        Block block{std::unique_ptr<char[]>(new char[size]), size};
+        if (fCurrent == fBlocks.size())
+            fBlocks.push_back(std::move(block));
+        else
+            fBlocks[fCurrent] = std::move(block);
+    }
+
+    fUsed = bytes;
+    return fBlocks[fCurrent].fData.get();
+}
+
+///////////////////////////////////////////////
+/// \brief It returns room for `bytes` bytes aligned to `alignment`, that
+/// must not be larger than the alignment of the new operator.
+///
+void* TRestLegacyArena::Allocate(size_t bytes, size_t alignment) {
+    if (!fBlocks.empty()) {
+        const size_t offset = (fUsed + alignment - 1) / alignment * alignment;
+        if (offset + bytes <= fBlocks[fCurrent].fSize) {
+            fUsed = offset + bytes;
+            return fBlocks[fCurrent].fData.get() + offset;
+        }
+    }
+    return NextBlock(bytes);
+}
+
+///////////////////////////////////////////////
+/// \brief It extends the allocation of `bytes` bytes at `data` with
+/// `extraBytes` more bytes, and it returns the location of the extended
+/// allocation.
+///
+/// If `data` is the last allocation and the current block has enough room,
+/// it is extended in place. Otherwise its content is copied to a new
+/// allocation. A null `data` with zero `bytes` is a new allocation.
+///
+void* TRestLegacyArena::Grow(void* data, size_t bytes, size_t extraBytes, size_t alignment) {
+    if (data != nullptr && !fBlocks.empty()) {
+        char* top = fBlocks[fCurrent].fData.get() + fUsed;
+        if ((char*)data + bytes == top && fUsed + extraBytes <= fBlocks[fCurrent].fSize) {
+            fUsed += extraBytes;
+            return data;
+        }
+    }
+
+    void* extended = Allocate(bytes + extraBytes, alignment);
+    if (bytes > 0) memcpy(extended, data, bytes);
+    return extended;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the total size of the blocks owned by the arena, in bytes
+///
+size_t TRestLegacyArena::GetCapacity() const {
+    size_t capacity = 0;
+    for (const auto& block : fBlocks) capacity += block.fSize;
+    return capacity;
+}
@@ -0,0 +1,80 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyArena
+#define RestCore_TRestLegacyArena
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//! A bump allocator whose allocations are all released at once
+class TRestLegacyArena {
+   private:
+    /// A block of memory from which the allocations are taken
+    struct Block {
+        std::unique_ptr<char[]> fData;
+        size_t fSize;
+    };
+
+    /// The blocks allocated so far. They are kept when the arena is reset.
+    std::vector<Block> fBlocks;
+
+    /// The block where the next allocation is taken from
+    size_t fCurrent = 0;
+
+    /// The number of bytes used in the current block
+    size_t fUsed = 0;
+
+    /// The minimum size of a new block, in bytes
+    size_t fBlockSize;
+
+    void* NextBlock(size_t bytes);
+
+   public:
+    void* Allocate(size_t bytes, size_t alignment);
+    void* Grow(void* data, size_t bytes, size_t extraBytes, size_t alignment);
+
+    /// It allocates room for `n` objects of type T, that must be trivially copyable
+    template <class T>
+    T* Allocate(size_t n) {
+        return (T*)Allocate(n * sizeof(T), alignof(T));
+    }
+
+    /// It extends the allocation of `size` objects at `data` to `size + extra` objects. It returns the
+    /// new location of the objects, that is only different from `data` if they had to be moved.
+    template <class T>
+    T* Grow(T* data, size_t size, size_t extra) {
+        return (T*)Grow(data, size * sizeof(T), extra * sizeof(T), alignof(T));
+    }
+
+    /// It releases all the allocations, keeping the memory for the next ones
+    void Reset() {
+        fCurrent = 0;
+        fUsed = 0;
+    }
+
+    size_t GetCapacity() const;
+
+    explicit TRestLegacyArena(size_t blockSize = 1 << 16) : fBlockSize(blockSize) {}
+};
+#endif
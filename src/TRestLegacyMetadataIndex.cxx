@@ -0,0 +1,291 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyMetadataIndex stores the parameters of the
+/// TRestRawZeroSuppresionProcess objects found in a set of run files in a
+/// compact sidecar file, so that the jobs that need them do not open the
+/// run files with ROOT again.
+///
+/// The index is built once with Build, that reads the run files using
+/// TRestLegacyMetadataScanner. The index file is a fixed Header followed
+/// by one Record per process, sorted by the fingerprint of the run file.
+/// The index is then opened through mmap, and a lookup is a binary search
+/// over the mapped records, without any ROOT I/O.
+///
+/// \code
+///     TRestLegacyMetadataIndex::Build("legacy.index", TRestTools::GetFilesMatchingPattern("/data/R*.root"));
+///
+///     TRestLegacyMetadataIndex index("legacy.index");
+///     for (const auto& record : index.Lookup("/data/R01234.root"))
+///         std::cout << record.fPointThreshold << std::endl;
+/// \endcode
+///
+/// The run files are identified by a fingerprint of their content, see
+/// Hash, so that a run file that is moved or copied is still found, and a
+/// run file that is modified is not. An empty lookup means that the run
+/// file was not indexed, or that it does not contain any legacy process.
+///
+/// A run file may store several processes. Each record keeps a hash of
+/// the name of its key, see HashName, and the record of one key is
+/// looked up giving also its name. The records of a run file are kept in
+/// the order of its keys.
+///
+/// The records are stored in the byte order of the machine that built
+/// the index.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyMetadataIndex
+///
+/// <hr>
+///
+
+#include "TRestLegacyMetadataIndex.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "TRestLegacyMetadataScanner.h"
+#include "TRestLegacyThreadPool.h"
+
+namespace {
+/// The first bytes of an index file
+constexpr char kMagic[8] = {'R', 'E', 'S', 'T', 'L', 'Z', 'S', 'I'};
+
+/// The number of bytes of the beginning and of the end of a run file used for its fingerprint
+constexpr size_t kHashBytes = 4096;
+
+static_assert(sizeof(TRestLegacyMetadataIndex::Header) == 24, "Unexpected padding in the index header");
+static_assert(sizeof(TRestLegacyMetadataIndex::Record) == 80, "Unexpected padding in the index records");
+
+/// It adds `size` bytes to the 64 bit FNV-1a hash `hash`, eight bytes at a time
+ULong64_t HashBytes(ULong64_t hash, const unsigned char* data, size_t size) {
+    for (size_t i = 0; i < size; i += 8) {
+        ULong64_t word = 0;
+        memcpy(&word, data + i, std::min<size_t>(8, size - i));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+}  // namespace
+
+TRestLegacyMetadataIndex::TRestLegacyMetadataIndex(const std::string& indexFile) {
+    const int descriptor = open(indexFile.c_str(), O_RDONLY);
+    if (descriptor < 0) return;
+
+    struct stat status;
+    if (fstat(descriptor, &status) == 0 && (size_t)status.st_size >= sizeof(Header)) {
+        void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (data != MAP_FAILED) {
+            fData = (const char*)data;
+            fSize = status.st_size;
+        }
+    }
+    close(descriptor);
+    if (fData == nullptr) return;
+
+    const Header* header = (const Header*)fData;
+    const Bool_t valid = memcmp(header->fMagic, kMagic, sizeof(kMagic)) == 0 &&
+                         header->fVersion == kVersion && header->fRecordSize == sizeof(Record) &&
+                         header->fNRecords == (fSize - sizeof(Header)) / sizeof(Record) &&
+                         (fSize - sizeof(Header)) % sizeof(Record) == 0;
+    if (!valid) {
+        munmap((void*)fData, fSize);
+        fData = nullptr;
+        fSize = 0;
+        return;
+    }
+
+    fRecords = (const Record*)(fData + sizeof(Header));
+    fNRecords = header->fNRecords;
+}
+
+TRestLegacyMetadataIndex::~TRestLegacyMetadataIndex() {
+    if (fData != nullptr) munmap((void*)fData, fSize);
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the fingerprint of the content of a run file, or 0 if it
+/// cannot be read.
+///
+/// Hashing a complete run file would read all its events. Instead, the
+/// fingerprint combines the size of the file with its first and its last
+/// kHashBytes bytes. The first ones contain the ROOT file header, with the
+/// location of the keys and of the free segments, that changes whenever an
+/// object is written to the file. The last ones contain the keys list and
+/// the streamer info in a file closed by ROOT.
+///
+ULong64_t TRestLegacyMetadataIndex::Hash(const std::string& runFile) {
+    const int descriptor = open(runFile.c_str(), O_RDONLY);
+    if (descriptor < 0) return 0;
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0) {
+        close(descriptor);
+        return 0;
+    }
+    const size_t size = status.st_size;
+
+    unsigned char head[kHashBytes];
+    unsigned char tail[kHashBytes];
+    const size_t nHead = std::min(size, kHashBytes);
+    const size_t nTail = std::min(size, kHashBytes);
+    const Bool_t read = pread(descriptor, head, nHead, 0) == (ssize_t)nHead &&
+                        pread(descriptor, tail, nTail, size - nTail) == (ssize_t)nTail;
+    close(descriptor);
+    if (!read) return 0;
+
+    ULong64_t hash = 0xcbf29ce484222325ULL;
+    hash = HashBytes(hash, (const unsigned char*)&size, sizeof(size));
+    hash = HashBytes(hash, head, nHead);
+    hash = HashBytes(hash, tail, nTail);
+
+    // A final mix, so that the low bits depend on all the words
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash == 0 ? 1 : hash;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the 32 bit FNV-1a hash of the key name `name`. It only
+/// tells apart the processes of the same run file.
+///
+UInt_t TRestLegacyMetadataIndex::HashName(const std::string& name) {
+    UInt_t hash = 0x811c9dc5;
+    for (unsigned char c : name) hash = (hash ^ c) * 0x01000193;
+    return hash;
+}
+
+///////////////////////////////////////////////
+/// \brief It writes the index file `indexFile` with the processes stored in
+/// `runFiles`, reading `nThreads` files at the same time. It returns true if
+/// the index file was written.
+///
+/// The run files that cannot be read are not indexed. The index file is
+/// written under a temporary name and then renamed, so that the jobs using
+/// a previous version of the index never see it partially written.
+///
+Bool_t TRestLegacyMetadataIndex::Build(const std::string& indexFile, const std::vector<std::string>& runFiles,
+                                       Int_t nThreads) {
+    TRestLegacyMetadataScanner scanner(nThreads);
+    scanner.Scan(runFiles);
+
+    std::vector<ULong64_t> hashes(runFiles.size());
+    const Int_t nHashThreads = std::max(1, std::min(scanner.GetNumberOfThreads(), (Int_t)runFiles.size()));
+    TRestLegacyThreadPool threadPool(nHashThreads);
+    threadPool.Run(runFiles.size(), [&](size_t file, Int_t) { hashes[file] = Hash(runFiles[file]); });
+
+    std::unordered_map<std::string, ULong64_t> fileHashes;
+    for (size_t file = 0; file < runFiles.size(); file++) fileHashes[runFiles[file]] = hashes[file];
+
+    std::vector<Record> records;
+    for (const auto& entry : scanner.GetEntries()) {
+        if (!entry.fError.empty()) continue;
+        const ULong64_t hash = fileHashes[entry.fFileName];
+        if (hash == 0) continue;
+
+        Record record;
+        memset(&record, 0, sizeof(Record));
+        record.fHash = hash;
+        record.fClassVersion = entry.fClassVersion;
+        record.fNPointsOverThreshold = entry.fNPointsOverThreshold;
+        record.fNPointsFlatThreshold = entry.fNPointsFlatThreshold;
+        record.fNameHash = HashName(entry.fName);
+        record.fBaseLineStart = entry.fBaseLineRange.X();
+        record.fBaseLineEnd = entry.fBaseLineRange.Y();
+        record.fIntegralStart = entry.fIntegralRange.X();
+        record.fIntegralEnd = entry.fIntegralRange.Y();
+        record.fPointThreshold = entry.fPointThreshold;
+        record.fSignalThreshold = entry.fSignalThreshold;
+        record.fSampling = entry.fSampling;
+        records.push_back(record);
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.fHash < b.fHash; });
+
+    Header header;
+    memcpy(header.fMagic, kMagic, sizeof(kMagic));
+    header.fVersion = kVersion;
+    header.fRecordSize = sizeof(Record);
+    header.fNRecords = records.size();
+
+    const std::string temporaryFile = indexFile + ".tmp";
+    std::ofstream output(temporaryFile, std::ios::binary | std::ios::trunc);
+    output.write((const char*)&header, sizeof(Header));
+    output.write((const char*)records.data(), records.size() * sizeof(Record));
+    output.close();
+    if (!output) {
+        std::remove(temporaryFile.c_str());
+        return false;
+    }
+    return std::rename(temporaryFile.c_str(), indexFile.c_str()) == 0;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the records of the run file with fingerprint `hash`.
+///
+std::vector<TRestLegacyMetadataIndex::Record> TRestLegacyMetadataIndex::Lookup(ULong64_t hash) const {
+    const Record* end = fRecords + fNRecords;
+    auto before = [](const Record& record, ULong64_t h) { return record.fHash < h; };
+    auto after = [](ULong64_t h, const Record& record) { return h < record.fHash; };
+    const Record* first = std::lower_bound(fRecords, end, hash, before);
+    const Record* last = std::upper_bound(first, end, hash, after);
+    return std::vector<Record>(first, last);
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the records of the run file `runFile`, identified by its
+/// fingerprint.
+///
+std::vector<TRestLegacyMetadataIndex::Record> TRestLegacyMetadataIndex::Lookup(
+    const std::string& runFile) const {
+    const ULong64_t hash = Hash(runFile);
+    if (hash == 0) return {};
+    return Lookup(hash);
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the record of the process stored with the key name `name`
+/// in the run file `runFile`, or none if it is not indexed. Only the highest
+/// cycle of each key is scanned, so a key has a single record.
+///
+std::vector<TRestLegacyMetadataIndex::Record> TRestLegacyMetadataIndex::Lookup(
+    const std::string& runFile, const std::string& name) const {
+    std::vector<Record> records = Lookup(runFile);
+    const UInt_t nameHash = HashName(name);
+    records.erase(std::remove_if(records.begin(), records.end(),
+                                 [nameHash](const Record& record) { return record.fNameHash != nameHash; }),
+                  records.end());
+    return records;
+}
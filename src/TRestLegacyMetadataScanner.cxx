@@ -0,0 +1,206 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyMetadataScanner reads the parameters of the
+/// TRestRawZeroSuppresionProcess objects stored in a list of run files,
+/// in order to audit the thresholds used in past data taking campaigns.
+///
+/// Opening each file with TRestRun reads all the metadata, the event
+/// trees and the analysis tree, and it dominates the time spent when
+/// thousands of files are scanned. Instead, the scanner only reads the
+/// list of keys of each file, and it deserializes only the keys of class
+/// TRestRawZeroSuppresionProcess. Several files are opened at the same
+/// time, each one by a different thread, so that the latency of the
+/// storage is overlapped. Since the scan is limited by the storage and
+/// not by the CPU, the number of threads may exceed the number of cores.
+///
+/// \code
+///     TRestLegacyMetadataScanner scanner(16);
+///     scanner.Scan(TRestTools::GetFilesMatchingPattern("/data/R*.root"));
+///     scanner.WriteTable(std::cout);
+/// \endcode
+///
+/// The table has one row per process found, and one row per file that
+/// could not be read, with the reason given in the last column. The macro
+/// REST_Legacy_ScanMetadata.C writes the table of the files matching a
+/// pattern.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyMetadataScanner
+///
+/// <hr>
+///
+
+#include "TRestLegacyMetadataScanner.h"
+
+#include <TFile.h>
+#include <TKey.h>
+#include <TROOT.h>
+#include <TStreamerInfo.h>
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include "TRestLegacyThreadPool.h"
+#include "TRestRawZeroSuppresionProcess.h"
+
+TRestLegacyMetadataScanner::TRestLegacyMetadataScanner(Int_t nThreads) : fNThreads(nThreads) {
+    if (fNThreads <= 0) fNThreads = std::max(1, (Int_t)std::thread::hardware_concurrency());
+}
+
+///////////////////////////////////////////////
+/// \brief It copies the parameters of `process` to `entry`.
+///
+void TRestLegacyMetadataScanner::FillParameters(const TRestRawZeroSuppresionProcess& process, Entry& entry) {
+    entry.fBaseLineRange = process.GetBaseLineRange();
+    entry.fIntegralRange = process.GetIntegralRange();
+    entry.fPointThreshold = process.GetPointThreshold();
+    entry.fSignalThreshold = process.GetSignalThreshold();
+    entry.fNPointsOverThreshold = process.GetNPointsOverThreshold();
+    entry.fNPointsFlatThreshold = process.GetNPointsFlatThreshold();
+    entry.fSampling = process.GetSampling();
+}
+
+///////////////////////////////////////////////
+/// \brief It adds to `entries` the processes stored in the file `fileName`.
+///
+/// If the file cannot be read, a single entry with an empty name and the
+/// reason in fError is added.
+///
+void TRestLegacyMetadataScanner::ScanFile(const std::string& fileName, std::vector<Entry>& entries) {
+    Entry failed;
+    failed.fFileName = fileName;
+
+    try {
+        std::unique_ptr<TFile> file(TFile::Open(fileName.c_str(), "READ"));
+        if (file == nullptr || file->IsZombie()) {
+            failed.fError = "The file cannot be opened";
+            entries.push_back(failed);
+            return;
+        }
+
+        // The streamer info stored in the file gives the class version used to write it
+        auto info =
+            (TStreamerInfo*)file->GetStreamerInfoCache()->FindObject("TRestRawZeroSuppresionProcess");
+        const Int_t classVersion = info == nullptr ? 0 : info->GetClassVersion();
+
+        // The keys with the same name are ordered from the highest cycle, only that one is read
+        std::set<std::string> names;
+        TIter next(file->GetListOfKeys());
+        while (TKey* key = (TKey*)next()) {
+            if (std::string(key->GetClassName()) != "TRestRawZeroSuppresionProcess") continue;
+            if (!names.insert(key->GetName()).second) continue;
+
+            Entry entry;
+            entry.fFileName = fileName;
+            entry.fName = key->GetName();
+            entry.fClassVersion = classVersion;
+
+            std::unique_ptr<TObject> object(key->ReadObj());
+            auto process = dynamic_cast<TRestRawZeroSuppresionProcess*>(object.get());
+            if (process == nullptr) {
+                entry.fError = "The process cannot be read";
+                entries.push_back(entry);
+                continue;
+            }
+
+            FillParameters(*process, entry);
+            entries.push_back(entry);
+        }
+    } catch (const std::exception& exception) {
+        failed.fError = exception.what();
+        entries.push_back(failed);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It reads the processes stored in the files `fileNames`, replacing
+/// the result of the previous scan.
+///
+void TRestLegacyMetadataScanner::Scan(const std::vector<std::string>& fileNames) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::vector<Entry>> fileEntries(fileNames.size());
+    const Int_t nThreads = std::min(fNThreads, (Int_t)fileNames.size());
+    if (nThreads > 1) {
+        ROOT::EnableThreadSafety();
+        TRestLegacyThreadPool threadPool(nThreads);
+        threadPool.Run(fileNames.size(),
+                       [&](size_t file, Int_t) { ScanFile(fileNames[file], fileEntries[file]); });
+    } else {
+        for (size_t file = 0; file < fileNames.size(); file++) ScanFile(fileNames[file], fileEntries[file]);
+    }
+
+    fEntries.clear();
+    fNFiles = fileNames.size();
+    fNFailedFiles = 0;
+    for (const auto& entries : fileEntries) {
+        if (entries.size() == 1 && entries[0].fName.empty()) fNFailedFiles++;
+        fEntries.insert(fEntries.end(), entries.begin(), entries.end());
+    }
+
+    fTime = std::chrono::duration<Double_t>(std::chrono::steady_clock::now() - start).count();
+}
+
+///////////////////////////////////////////////
+/// \brief Returns `field` as a field of a table, quoted and with its quotes
+/// doubled, as given by RFC 4180 for CSV files.
+///
+std::string TRestLegacyMetadataScanner::QuoteField(const std::string& field) {
+    std::string quoted = "\"";
+    for (char c : field) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+///////////////////////////////////////////////
+/// \brief It writes the processes found by the last scan as a table, with a
+/// header line and one line per process, whose columns are separated by
+/// `separator`. The text fields are quoted, see QuoteField.
+///
+void TRestLegacyMetadataScanner::WriteTable(std::ostream& output, char separator) const {
+    output << "file" << separator << "name" << separator << "classVersion" << separator << "baseLineStart"
+           << separator << "baseLineEnd" << separator << "integralStart" << separator << "integralEnd"
+           << separator << "pointThreshold" << separator << "signalThreshold" << separator
+           << "nPointsOverThreshold" << separator << "nPointsFlatThreshold" << separator << "sampling"
+           << separator << "error" << std::endl;
+
+    for (const auto& entry : fEntries) {
+        output << QuoteField(entry.fFileName) << separator << QuoteField(entry.fName) << separator
+               << entry.fClassVersion << separator
+               << entry.fBaseLineRange.X() << separator << entry.fBaseLineRange.Y() << separator
+               << entry.fIntegralRange.X() << separator << entry.fIntegralRange.Y() << separator
+               << entry.fPointThreshold << separator << entry.fSignalThreshold << separator
+               << entry.fNPointsOverThreshold << separator << entry.fNPointsFlatThreshold << separator
+               << entry.fSampling << separator << QuoteField(entry.fError) << std::endl;
+    }
+}
@@ -0,0 +1,312 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyMigration prepares the reprocessing of the run files
+/// produced with the legacy TRestRawZeroSuppresionProcess by writing the
+/// equivalent TRestRawToDetectorSignalProcess configurations.
+///
+/// The run files are read concurrently by TRestLegacyMetadataScanner, and
+/// the parameters of each legacy process are converted to a
+/// TRestRawToDetectorSignalProcess RML section with GetModernSection. The
+/// processes with the same parameters share the same section, named after
+/// a hash of its parameters, so that the name of a configuration does not
+/// depend on the files migrated with it.
+///
+/// Write stores each distinct section in its own RML file, and a table
+/// named legacyZeroSuppression.csv that gives the section used by each
+/// process found in each run file.
+///
+/// \code
+///     TRestLegacyMigration migration(16);
+///     migration.Migrate(TRestTools::GetFilesMatchingPattern("/data/R*.root"));
+///     migration.Write("/data/migration");
+/// \endcode
+///
+/// The macro REST_Legacy_MigrateMetadata.C migrates the run files
+/// matching a pattern.
+///
+/// Alternatively, Rewrite replaces the legacy processes stored in a run
+/// file by their TRestRawToDetectorSignalProcess equivalents, in place.
+/// The file is updated by ROOT, so that only the new objects, the list of
+/// keys and the file header are written, and the event trees are left
+/// untouched. The macro REST_Legacy_RewriteMetadata.C rewrites the run
+/// files matching a pattern.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyMigration
+///
+/// <hr>
+///
+
+#include "TRestLegacyMigration.h"
+
+#include <TClass.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TSystem.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+
+#include "TRestEventProcess.h"
+#include "TRestLegacyRegistry.h"
+#include "TRestRawZeroSuppresionProcess.h"
+
+namespace {
+/// The replacement of the legacy process migrated
+constexpr const TRestLegacyRegistry::Replacement* kReplacement =
+    TRestLegacyRegistry::Find("TRestRawZeroSuppresionProcess");
+
+/// Returns the shortest representation of `value` that is read back as the same value
+std::string FormatValue(Double_t value) {
+    char text[32];
+    for (Int_t precision = 15; precision < 17; precision++) {
+        snprintf(text, sizeof(text), "%.*g", precision, value);
+        if (strtod(text, nullptr) == value) return text;
+    }
+    snprintf(text, sizeof(text), "%.17g", value);
+    return text;
+}
+
+/// Returns the 64 bit FNV-1a hash of `text` as 16 hexadecimal digits
+std::string HashText(const std::string& text) {
+    ULong64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned char c : text) hash = (hash ^ c) * 0x100000001b3ULL;
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)hash);
+    return hex;
+}
+}  // namespace
+
+///////////////////////////////////////////////
+/// \brief Returns the TRestRawToDetectorSignalProcess RML section, named
+/// `name`, equivalent to the legacy process with the given parameters.
+///
+/// The names of the modern parameters, and the modern parameters with a
+/// fixed value, as the one enabling the zero suppression, are given by
+/// TRestLegacyRegistry. The verbose level is only given if `verboseLevel`
+/// is not empty.
+///
+std::string TRestLegacyMigration::GetModernSection(const TRestLegacyMetadataScanner::Entry& parameters,
+                                                   const std::string& name, const std::string& verboseLevel) {
+    std::ostringstream section;
+    auto parameter = [&section](const std::string& parameterName, const std::string& value) {
+        section << "    <parameter name=\"" << parameterName << "\" value=\"" << value << "\" />"
+                << std::endl;
+    };
+    auto member = [&parameter](const char* legacyMember, const std::string& value) {
+        const char* modernName =
+            TRestLegacyRegistry::GetModernParameter(kReplacement->fLegacyClass, legacyMember);
+        if (modernName != nullptr) parameter(modernName, value);
+    };
+    auto range = [](const TVector2& vector) {
+        return "(" + FormatValue(vector.X()) + "," + FormatValue(vector.Y()) + ")";
+    };
+
+    section << "<" << kReplacement->fModernClass << " name=\"" << name << "\"";
+    if (!verboseLevel.empty()) section << " verboseLevel=\"" << verboseLevel << "\"";
+    section << ">" << std::endl;
+    for (Int_t n = 0; n < kReplacement->fNSettings; n++)
+        parameter(kReplacement->fSettings[n].fName, kReplacement->fSettings[n].fValue);
+    member("fBaseLineRange", range(parameters.fBaseLineRange));
+    member("fIntegralRange", range(parameters.fIntegralRange));
+    member("fPointThreshold", FormatValue(parameters.fPointThreshold));
+    member("fSignalThreshold", FormatValue(parameters.fSignalThreshold));
+    member("fNPointsOverThreshold", std::to_string(parameters.fNPointsOverThreshold));
+    member("fNPointsFlatThreshold", std::to_string(parameters.fNPointsFlatThreshold));
+    member("fSampling", FormatValue(parameters.fSampling));
+    section << "</" << kReplacement->fModernClass << ">" << std::endl;
+    return section.str();
+}
+
+///////////////////////////////////////////////
+/// \brief Returns a new TRestRawToDetectorSignalProcess configured with the
+/// section given by GetModernSection, or nullptr if the class is not
+/// available or the process could not be configured. The caller owns the
+/// process.
+///
+/// The modern process is created by name, so that it is only required
+/// when a migration is done.
+///
+TRestEventProcess* TRestLegacyMigration::CreateModernProcess(
+    const TRestLegacyMetadataScanner::Entry& parameters, const std::string& name,
+    const std::string& verboseLevel) {
+    TClass* modernClass = TClass::GetClass(kReplacement->fModernClass);
+    if (modernClass == nullptr) return nullptr;
+    std::unique_ptr<TRestEventProcess> process((TRestEventProcess*)modernClass->New());
+    if (process == nullptr) return nullptr;
+
+    TString fileName = "legacyMigration";
+    FILE* file = gSystem->TempFileName(fileName);
+    if (file == nullptr) return nullptr;
+    const std::string config =
+        "<config>\n" + GetModernSection(parameters, name, verboseLevel) + "</config>\n";
+    const Bool_t written = fputs(config.c_str(), file) >= 0;
+    const Bool_t closed = fclose(file) == 0;
+
+    const Int_t status = written && closed ? process->LoadConfigFromFile(fileName.Data()) : -1;
+    gSystem->Unlink(fileName);
+    return status == 0 ? process.release() : nullptr;
+}
+
+///////////////////////////////////////////////
+/// \brief It replaces each TRestRawZeroSuppresionProcess stored in the run
+/// file `fileName` by the equivalent TRestRawToDetectorSignalProcess, written
+/// with the same key name. It returns the number of processes replaced, or -1
+/// if the file could not be rewritten. The file is not modified if any of
+/// its processes cannot be converted.
+///
+/// The new objects are appended to the file, or written to the space freed
+/// by the legacy ones, and closing the file updates the list of keys, the
+/// streamer info and the file header. The rest of the file, including the
+/// baskets of the event trees, is not read nor written.
+///
+Int_t TRestLegacyMigration::Rewrite(const std::string& fileName) {
+    if (TClass::GetClass(kReplacement->fModernClass) == nullptr) {
+        RESTError << "TRestLegacyMigration. " << kReplacement->fModernClass << " is not available"
+                  << RESTendl;
+        return -1;
+    }
+
+    std::unique_ptr<TFile> file(TFile::Open(fileName.c_str(), "UPDATE"));
+    if (file == nullptr || file->IsZombie() || !file->IsWritable()) {
+        RESTError << "TRestLegacyMigration. " << fileName << " cannot be opened for writing" << RESTendl;
+        return -1;
+    }
+
+    // The keys with the same name are ordered from the highest cycle, only that one is converted
+    std::vector<std::string> names;
+    std::set<std::string> found;
+    TIter next(file->GetListOfKeys());
+    while (TKey* key = (TKey*)next()) {
+        if (std::string(key->GetClassName()) != "TRestRawZeroSuppresionProcess") continue;
+        if (found.insert(key->GetName()).second) names.push_back(key->GetName());
+    }
+
+    // All the processes are converted before the file is modified
+    std::vector<std::unique_ptr<TRestEventProcess>> modernProcesses;
+    for (const auto& name : names) {
+        std::unique_ptr<TObject> object(file->GetKey(name.c_str())->ReadObj());
+        auto legacyProcess = dynamic_cast<TRestRawZeroSuppresionProcess*>(object.get());
+        if (legacyProcess == nullptr) {
+            RESTError << "TRestLegacyMigration. " << name << " cannot be read from " << fileName << RESTendl;
+            return -1;
+        }
+
+        TRestLegacyMetadataScanner::Entry parameters;
+        TRestLegacyMetadataScanner::FillParameters(*legacyProcess, parameters);
+        modernProcesses.emplace_back(CreateModernProcess(parameters, name));
+        if (modernProcesses.back() == nullptr) {
+            RESTError << "TRestLegacyMigration. " << name << " from " << fileName
+                      << " cannot be converted to " << kReplacement->fModernClass << RESTendl;
+            return -1;
+        }
+    }
+
+    file->cd();
+    for (size_t n = 0; n < names.size(); n++) {
+        file->Delete((names[n] + ";*").c_str());
+        modernProcesses[n]->Write(names[n].c_str());
+    }
+    file->Close();
+    return names.size();
+}
+
+///////////////////////////////////////////////
+/// \brief It reads the legacy processes stored in the files `fileNames`, and
+/// it assigns them their equivalent configurations, replacing the result of
+/// the previous migration.
+///
+void TRestLegacyMigration::Migrate(const std::vector<std::string>& fileNames) {
+    TRestLegacyMetadataScanner scanner(fNThreads);
+    scanner.Scan(fileNames);
+
+    fMappings.clear();
+    fConfigNames.clear();
+    fConfigs.clear();
+
+    // The sections without a name identify the distinct parameters
+    std::map<std::string, size_t> configIndex;
+    for (const auto& entry : scanner.GetEntries()) {
+        Mapping mapping;
+        mapping.fFileName = entry.fFileName;
+        mapping.fName = entry.fName;
+        mapping.fError = entry.fError;
+
+        if (entry.fError.empty()) {
+            const std::string parameters = GetModernSection(entry, "");
+            auto config = configIndex.find(parameters);
+            if (config == configIndex.end()) {
+                config = configIndex.emplace(parameters, fConfigs.size()).first;
+                fConfigNames.push_back("legacyZeroSuppression_" + HashText(parameters));
+                fConfigs.push_back(GetModernSection(entry, fConfigNames.back()));
+            }
+            mapping.fConfigName = fConfigNames[config->second];
+        }
+        fMappings.push_back(mapping);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It writes the configurations produced by the last migration to
+/// `outputDirectory`, one RML file per configuration, and the table with
+/// the configuration of each process. It returns false as soon as a file
+/// cannot be written.
+///
+/// The table follows RFC 4180: every field is quoted, and the quotes in a
+/// field are doubled.
+///
+Bool_t TRestLegacyMigration::Write(const std::string& outputDirectory) const {
+    gSystem->mkdir(outputDirectory.c_str(), kTRUE);
+
+    for (size_t n = 0; n < fConfigs.size(); n++) {
+        std::ofstream config(outputDirectory + "/" + fConfigNames[n] + ".rml");
+        config << fConfigs[n];
+        if (!config) return false;
+        config.close();
+        if (!config) return false;
+    }
+
+    // Every field is quoted, as file and key names may contain commas or quotes
+    std::ofstream table(outputDirectory + "/legacyZeroSuppression.csv");
+    table << "file,name,config,error" << std::endl;
+    if (!table) return false;
+    for (const auto& mapping : fMappings) {
+        table << TRestLegacyMetadataScanner::QuoteField(mapping.fFileName) << ","
+              << TRestLegacyMetadataScanner::QuoteField(mapping.fName) << ","
+              << TRestLegacyMetadataScanner::QuoteField(mapping.fConfigName) << ","
+              << TRestLegacyMetadataScanner::QuoteField(mapping.fError) << std::endl;
+        if (!table) return false;
+    }
+    table.close();
+    return (Bool_t)table;
+}
@@ -26,6 +26,39 @@
 /// kept to keep backward compatibility with previous REST realeases.
 /// The creation of a legacy process is not allowed, you will have some
 /// errors and warnings in case you attempt to run a legacy process.
+///
+/// Some legacy processes implement a replay of their persisted parameters,
+/// so that archived data can be reprocessed with the exact historical
+/// settings. The replay is opt-in, it must be enabled explicitly by calling
+/// `TRestLegacyProcess::SetReplayMode(true)` or by defining the environment
+/// variable `REST_LEGACY_REPLAY=1` before the processes are created. Legacy
+/// processes not implementing the replay will still stop the execution.
+///
+/// A replayed process may share the work of each event among several
+/// threads, that are defined by `TRestLegacyProcess::SetReplayThreads` or by
+/// the environment variable `REST_LEGACY_REPLAY_THREADS`. By default each
+/// event is processed by a single thread.
+///
+/// Legacy classes warn only when their first instance is created, since
+/// ROOT I/O creates one instance each time a legacy process is read. The
+/// instances of each legacy class are counted in a process-wide registry,
+/// see GetInstanceCounts, and a summary of the counts is printed by
+/// PrintInstanceSummary, which is called when the program exits, before
+/// ROOT is cleaned up.
+///
+/// The legacy objects read from files are also counted by the streamers of
+/// their classes, together with the bytes read and the time spent reading
+/// them, so that all the reads are counted, whether they are done by
+/// TRestRun, TFile::Get or TKey::ReadObj.
+/// These metrics are returned by GetMetrics, and WriteMetrics writes them
+/// as JSON or in the Prometheus text format. If the environment variable
+/// `REST_LEGACY_METRICS` gives a file name, the metrics are written to it
+/// when the program ends, as JSON if its extension is `.json` and in the
+/// Prometheus format otherwise, e.g. for the textfile collector of the
+/// Prometheus node exporter.
+///
+///--------------------------------------------------------------------------
+///
 /// RESTsoft - Software for Rare Event Searches with TPCs
 ///
 ///----------------------------------------------------------------------
@@ -45,4 +78,186 @@
 
 #include "TRestLegacyProcess.h"
 
+#include <TROOT.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
 ClassImp(TRestLegacyProcess);
+
+namespace {
+Bool_t ReplayModeFromEnvironment() {
+    const char* replay = getenv("REST_LEGACY_REPLAY");
+    return replay != nullptr && std::string(replay) != "" && std::string(replay) != "0";
+}
+
+Int_t ReplayThreadsFromEnvironment() {
+    const char* threads = getenv("REST_LEGACY_REPLAY_THREADS");
+    if (threads == nullptr) return 1;
+    return std::max(atoi(threads), 1);
+}
+}  // namespace
+
+struct TRestLegacyProcess::Counters {
+    /// The number of instances created
+    std::atomic<Long64_t> fInstances{0};
+
+    /// The number of objects read from files, their uncompressed size and the time spent
+    std::atomic<Long64_t> fReads{0};
+    std::atomic<Long64_t> fBytesRead{0};
+    std::atomic<Long64_t> fReadNanoseconds{0};
+};
+
+namespace {
+/// The counters of the legacy classes instantiated in this process, that are summarized when it ends
+struct CountersRegistry {
+    std::mutex fMutex;
+    std::map<std::string, std::unique_ptr<TRestLegacyProcess::Counters>> fCounters;
+};
+
+/// It prints the summary of the legacy instances, and it writes the metrics if requested
+void SummarizeAtExit() {
+    TRestLegacyProcess::PrintInstanceSummary();
+
+    const char* metricsFile = getenv("REST_LEGACY_METRICS");
+    if (metricsFile == nullptr || std::string(metricsFile).empty()) return;
+    const std::string fileName = metricsFile;
+    const Bool_t json = fileName.size() >= 5 && fileName.compare(fileName.size() - 5, 5, ".json") == 0;
+    TRestLegacyProcess::WriteMetrics(fileName, json ? "json" : "prometheus");
+}
+
+CountersRegistry& GetRegistry() {
+    static CountersRegistry registry;
+
+    // The summary is not printed by a static destructor, when the REST logging or ROOT may be gone.
+    // Creating gROOT first registers its cleanup before the handler, so that it runs after the summary
+    (void)gROOT;
+    static const Int_t exitHandler = std::atexit(SummarizeAtExit);
+    (void)exitHandler;
+    return registry;
+}
+}  // namespace
+
+Bool_t TRestLegacyProcess::fReplayMode = ReplayModeFromEnvironment();
+Int_t TRestLegacyProcess::fReplayThreads = ReplayThreadsFromEnvironment();
+
+///////////////////////////////////////////////
+/// \brief Returns the counters of the legacy class `className`, which are
+/// created the first time they are requested.
+///
+/// The counters are never destroyed, so the legacy classes may keep a
+/// reference to them in a static variable, and update them without locking.
+///
+TRestLegacyProcess::Counters& TRestLegacyProcess::GetCounters(const std::string& className) {
+    CountersRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.fMutex);
+    auto& counters = registry.fCounters[className];
+    if (counters == nullptr) counters.reset(new Counters());
+    return *counters;
+}
+
+///////////////////////////////////////////////
+/// \brief It counts a new instance of a legacy class. It returns true only
+/// for the first instance, that should warn about the usage of the class.
+///
+Bool_t TRestLegacyProcess::CountInstance(Counters& counters) { return counters.fInstances++ == 0; }
+
+///////////////////////////////////////////////
+/// \brief It counts an object of a legacy class read from a file, with the
+/// bytes taken from the buffer and the time spent. It is called by the
+/// streamers of the legacy classes.
+///
+void TRestLegacyProcess::CountRead(Counters& counters, Long64_t bytes, Long64_t nanoseconds) {
+    counters.fReads++;
+    counters.fBytesRead += bytes;
+    counters.fReadNanoseconds += nanoseconds;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the metrics of each legacy class used in this program.
+///
+std::map<std::string, TRestLegacyProcess::Metrics> TRestLegacyProcess::GetMetrics() {
+    CountersRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.fMutex);
+    std::map<std::string, Metrics> metrics;
+    for (const auto& counters : registry.fCounters) {
+        Metrics& classMetrics = metrics[counters.first];
+        classMetrics.fInstances = counters.second->fInstances;
+        classMetrics.fReads = counters.second->fReads;
+        classMetrics.fBytesRead = counters.second->fBytesRead;
+        classMetrics.fReadTime = counters.second->fReadNanoseconds * 1e-9;
+    }
+    return metrics;
+}
+
+///////////////////////////////////////////////
+/// \brief It writes the metrics of each legacy class to `fileName`. The
+/// format is `json` or `prometheus`, the Prometheus text format. It returns
+/// true if the file was written.
+///
+Bool_t TRestLegacyProcess::WriteMetrics(const std::string& fileName, const std::string& format) {
+    if (format != "json" && format != "prometheus") return false;
+    const auto metrics = GetMetrics();
+
+    std::ofstream file(fileName);
+    if (format == "json") {
+        file << "{\n";
+        file << "  \"classes\": {";
+        for (auto classMetrics = metrics.begin(); classMetrics != metrics.end(); classMetrics++) {
+            const Metrics& values = classMetrics->second;
+            file << (classMetrics == metrics.begin() ? "\n" : ",\n");
+            file << "    \"" << classMetrics->first << "\": {\"instances\": " << values.fInstances
+                 << ", \"reads\": " << values.fReads << ", \"bytesRead\": " << values.fBytesRead
+                 << ", \"readSeconds\": " << values.fReadTime << "}";
+        }
+        file << (metrics.empty() ? "}\n" : "\n  }\n");
+        file << "}\n";
+    } else {
+        auto metric = [&](const std::string& name, const std::string& help, auto value) {
+            file << "# HELP " << name << " " << help << "\n";
+            file << "# TYPE " << name << " counter\n";
+            for (const auto& classMetrics : metrics)
+                file << name << "{class=\"" << classMetrics.first << "\"} " << value(classMetrics.second)
+                     << "\n";
+        };
+        metric("rest_legacy_instances_total", "Instances created of each legacy class",
+               [](const Metrics& values) { return values.fInstances; });
+        metric("rest_legacy_reads_total", "Objects of each legacy class read from files",
+               [](const Metrics& values) { return values.fReads; });
+        metric("rest_legacy_read_bytes_total", "Uncompressed bytes of the legacy objects read",
+               [](const Metrics& values) { return values.fBytesRead; });
+        metric("rest_legacy_read_seconds_total", "Time spent reading the legacy objects",
+               [](const Metrics& values) { return values.fReadTime; });
+    }
+    file.close();
+    return (Bool_t)file;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the number of instances created of each legacy class.
+///
+std::map<std::string, Long64_t> TRestLegacyProcess::GetInstanceCounts() {
+    CountersRegistry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.fMutex);
+    std::map<std::string, Long64_t> counts;
+    for (const auto& counters : registry.fCounters) counts[counters.first] = counters.second->fInstances;
+    return counts;
+}
+
+///////////////////////////////////////////////
+/// \brief It prints the number of instances created of each legacy class, if
+/// any was created. It is called when the program exits, before ROOT is
+/// cleaned up, and it can also be called at any time.
+///
+void TRestLegacyProcess::PrintInstanceSummary() {
+    const auto counts = GetInstanceCounts();
+    if (counts.empty()) return;
+
+    RESTMetadata << "Legacy classes instantiated in this process:" << RESTendl;
+    for (const auto& count : counts) RESTMetadata << "  " << count.first << " : " << count.second << RESTendl;
+}
@@ -0,0 +1,242 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyReplayValidator checks that the replay of the parameters of
+/// a legacy TRestRawZeroSuppresionProcess gives the same result as the
+/// process that replaced it, TRestRawToDetectorSignalProcess, before the
+/// replay is used to reprocess old data.
+///
+/// The validator creates a TRestRawToDetectorSignalProcess with the zero
+/// suppression enabled, and it sets directly the parameters equivalent to
+/// the ones of the legacy process, see GetModernConfig. Then, each event
+/// given to Validate is processed by both, and the signals produced are
+/// compared point by point. The signals are matched by their id, and two
+/// points are considered equal if their times and their amplitudes differ
+/// at most the tolerance given to the constructor. The time spent by each
+/// process is measured as well.
+///
+/// The replay mode of legacy processes must be enabled, see
+/// TRestLegacyProcess::SetReplayMode.
+///
+/// \code
+///     TRestLegacyProcess::SetReplayMode(true);
+///     TRestRun run("R01234.root");
+///     auto legacy = (TRestRawZeroSuppresionProcess*)run.GetMetadataClass("TRestRawZeroSuppresionProcess");
+///
+///     TRestLegacyReplayValidator validator(legacy);
+///     validator.ValidateSynthetic(100);
+///     validator.PrintReport();
+/// \endcode
+///
+/// The events can also be taken from a raw data file, as done by the macro
+/// REST_Legacy_ValidateReplay.C.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyReplayValidator
+///
+/// <hr>
+///
+
+#include "TRestLegacyReplayValidator.h"
+
+#include <TRestRawToDetectorSignalProcess.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+
+#include "TRestLegacyMetadataScanner.h"
+#include "TRestLegacyMigration.h"
+#include "TRestLegacySignalGenerator.h"
+#include "TRestRawZeroSuppresionProcess.h"
+
+namespace {
+/// TRestRawToDetectorSignalProcess with the zero suppression parameters of a legacy process. They
+/// are protected members, so they are set by a derived class. A change of the modern members then
+/// breaks the build, instead of leaving a parameter silently at its default value.
+class ModernProcess : public TRestRawToDetectorSignalProcess {
+   public:
+    explicit ModernProcess(const TRestLegacyMetadataScanner::Entry& parameters) {
+        SetName("legacyReplayValidation");
+        fZeroSuppression = true;
+        fBaseLineRange = parameters.fBaseLineRange;
+        fIntegralRange = parameters.fIntegralRange;
+        fPointThreshold = parameters.fPointThreshold;
+        fSignalThreshold = parameters.fSignalThreshold;
+        fNPointsOverThreshold = parameters.fNPointsOverThreshold;
+        fNPointsFlatThreshold = parameters.fNPointsFlatThreshold;
+        fSampling = parameters.fSampling;
+    }
+};
+}  // namespace
+
+TRestLegacyReplayValidator::TRestLegacyReplayValidator(TRestRawZeroSuppresionProcess* legacyProcess,
+                                                       Double_t tolerance)
+    : fLegacyProcess(legacyProcess), fTolerance(tolerance) {
+    if (!TRestLegacyProcess::IsReplayMode())
+        RESTWarning << "TRestLegacyReplayValidator. The replay mode of legacy processes is not enabled, "
+                       "see TRestLegacyProcess::SetReplayMode"
+                    << RESTendl;
+
+    TRestLegacyMetadataScanner::Entry parameters;
+    TRestLegacyMetadataScanner::FillParameters(*fLegacyProcess, parameters);
+    fModernProcess = new ModernProcess(parameters);
+    fModernProcess->InitProcess();
+}
+
+TRestLegacyReplayValidator::~TRestLegacyReplayValidator() { delete fModernProcess; }
+
+///////////////////////////////////////////////
+/// \brief Returns the RML configuring TRestRawToDetectorSignalProcess with
+/// the parameters of the legacy process, see
+/// TRestLegacyMigration::GetModernSection.
+///
+std::string TRestLegacyReplayValidator::GetModernConfig() const {
+    TRestLegacyMetadataScanner::Entry parameters;
+    TRestLegacyMetadataScanner::FillParameters(*fLegacyProcess, parameters);
+    const std::string section =
+        TRestLegacyMigration::GetModernSection(parameters, "legacyReplayValidation", "silent");
+    return "<config>\n" + section + "</config>\n";
+}
+
+///////////////////////////////////////////////
+/// \brief It processes `rawEvent` with both processes, and it compares their
+/// results. It returns true if they are equal.
+///
+Bool_t TRestLegacyReplayValidator::Validate(TRestRawSignalEvent* rawEvent) {
+    const auto start = std::chrono::steady_clock::now();
+    fLegacyProcess->Replay(rawEvent, &fLegacyEvent);
+    const auto middle = std::chrono::steady_clock::now();
+
+    auto modernEvent = (TRestDetectorSignalEvent*)fModernProcess->ProcessEvent(rawEvent);
+    const auto end = std::chrono::steady_clock::now();
+
+    fReport.fLegacyTime += std::chrono::duration<Double_t>(middle - start).count();
+    fReport.fModernTime += std::chrono::duration<Double_t>(end - middle).count();
+    fReport.fNEvents++;
+
+    const Bool_t equal = Compare(fLegacyEvent, modernEvent);
+    if (!equal) fReport.fNEventsWithDifferences++;
+    return equal;
+}
+
+///////////////////////////////////////////////
+/// \brief It validates `nEvents` events produced by TRestLegacySignalGenerator,
+/// with `nChannels` channels of `nSamples` samples.
+///
+void TRestLegacyReplayValidator::ValidateSynthetic(Int_t nEvents, Int_t nChannels, Int_t nSamples,
+                                                   ULong64_t seed) {
+    TRestLegacySignalGenerator::Parameters parameters;
+    parameters.fNChannels = nChannels;
+    parameters.fNSamples = nSamples;
+    parameters.fSeed = seed;
+    TRestLegacySignalGenerator generator(parameters);
+
+    TRestRawSignalEvent rawEvent;
+    for (Int_t n = 0; n < nEvents; n++) {
+        generator.Generate(n, &rawEvent);
+        Validate(&rawEvent);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It compares the signals of both events, adding the differences to
+/// the report. The modern event is empty if it is nullptr.
+///
+Bool_t TRestLegacyReplayValidator::Compare(const TRestDetectorSignalEvent& legacyEvent,
+                                           TRestDetectorSignalEvent* modernEvent) {
+    std::map<Int_t, TRestDetectorSignal*> modernSignals;
+    const Int_t nModernSignals = modernEvent == nullptr ? 0 : modernEvent->GetNumberOfSignals();
+    for (Int_t s = 0; s < nModernSignals; s++) {
+        TRestDetectorSignal* signal = modernEvent->GetSignal(s);
+        modernSignals[signal->GetSignalID()] = signal;
+    }
+
+    Bool_t equal = true;
+    TRestDetectorSignalEvent& legacy = const_cast<TRestDetectorSignalEvent&>(legacyEvent);
+    for (Int_t s = 0; s < legacy.GetNumberOfSignals(); s++) {
+        TRestDetectorSignal* legacySignal = legacy.GetSignal(s);
+        fReport.fNSignals++;
+        fReport.fNPoints += legacySignal->GetNumberOfPoints();
+
+        const auto match = modernSignals.find(legacySignal->GetSignalID());
+        if (match == modernSignals.end()) {
+            fReport.fNMissingSignals++;
+            equal = false;
+            continue;
+        }
+        TRestDetectorSignal* modernSignal = match->second;
+        modernSignals.erase(match);
+
+        if (modernSignal->GetNumberOfPoints() != legacySignal->GetNumberOfPoints()) {
+            fReport.fNDifferentSignals++;
+            equal = false;
+            continue;
+        }
+
+        for (Int_t p = 0; p < legacySignal->GetNumberOfPoints(); p++) {
+            const Double_t timeDifference = std::abs(modernSignal->GetTime(p) - legacySignal->GetTime(p));
+            const Double_t amplitudeDifference =
+                std::abs(modernSignal->GetData(p) - legacySignal->GetData(p));
+            fReport.fMaxTimeDifference = std::max(fReport.fMaxTimeDifference, timeDifference);
+            fReport.fMaxAmplitudeDifference = std::max(fReport.fMaxAmplitudeDifference, amplitudeDifference);
+            if (timeDifference > fTolerance || amplitudeDifference > fTolerance) {
+                fReport.fNDifferentPoints++;
+                equal = false;
+            }
+        }
+    }
+
+    fReport.fNExtraSignals += modernSignals.size();
+    return equal && modernSignals.empty();
+}
+
+///////////////////////////////////////////////
+/// \brief It prints the comparison of the events validated so far, and the
+/// throughput of both processes.
+///
+void TRestLegacyReplayValidator::PrintReport() const {
+    auto rate = [](Long64_t n, Double_t time) { return time > 0 ? n / time : 0.; };
+
+    RESTMetadata << "Legacy replay validation" << RESTendl;
+    RESTMetadata << "------------------------" << RESTendl;
+    RESTMetadata << "Events : " << fReport.fNEvents
+                 << ", with differences : " << fReport.fNEventsWithDifferences << RESTendl;
+    RESTMetadata << "Legacy signals : " << fReport.fNSignals << ", points : " << fReport.fNPoints << RESTendl;
+    RESTMetadata << "Signals only in the legacy replay : " << fReport.fNMissingSignals << RESTendl;
+    RESTMetadata << "Signals only in TRestRawToDetectorSignalProcess : " << fReport.fNExtraSignals
+                 << RESTendl;
+    RESTMetadata << "Signals with a different number of points : " << fReport.fNDifferentSignals << RESTendl;
+    RESTMetadata << "Points different beyond the tolerance (" << fTolerance
+                 << ") : " << fReport.fNDifferentPoints << RESTendl;
+    RESTMetadata << "Max time difference : " << fReport.fMaxTimeDifference
+                 << ", max amplitude difference : " << fReport.fMaxAmplitudeDifference << RESTendl;
+    RESTMetadata << "Legacy replay : " << rate(fReport.fNEvents, fReport.fLegacyTime) << " events/s"
+                 << RESTendl;
+    RESTMetadata << "TRestRawToDetectorSignalProcess : " << rate(fReport.fNEvents, fReport.fModernTime)
+                 << " events/s" << RESTendl;
+}
@@ -0,0 +1,92 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyRingBuffer
+#define RestCore_TRestLegacyRingBuffer
+
+#include <Rtypes.h>
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+//! A lock-free queue of fixed capacity, for a single producer and a single consumer thread
+///
+/// The producer only writes the tail and the consumer only writes the head, each of them in its own
+/// cache line. An element is published by the release store of the tail, and it is released by the
+/// release store of the head, so no lock or compare-and-swap is ever needed.
+template <class T>
+class TRestLegacyRingBuffer {
+   private:
+    /// The elements, with room for a power of two elements
+    std::vector<T> fData;
+
+    /// The capacity minus one, used to wrap the positions
+    size_t fMask;
+
+    /// The position of the next element to pop. Only written by the consumer.
+    alignas(64) std::atomic<size_t> fHead{0};
+
+    /// The position of the next element to push. Only written by the producer.
+    alignas(64) std::atomic<size_t> fTail{0};
+
+    static size_t RoundCapacity(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+
+   public:
+    /// It adds `element` at the end of the queue. It returns false if the queue is full.
+    Bool_t TryPush(const T& element) {
+        const size_t tail = fTail.load(std::memory_order_relaxed);
+        if (tail - fHead.load(std::memory_order_acquire) == fData.size()) return false;
+        fData[tail & fMask] = element;
+        fTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// It takes the first element of the queue into `element`. It returns false if the queue is empty.
+    Bool_t TryPop(T& element) {
+        const size_t head = fHead.load(std::memory_order_relaxed);
+        if (head == fTail.load(std::memory_order_acquire)) return false;
+        element = fData[head & fMask];
+        fHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns the number of elements in the queue. It is only exact if no other thread modifies it.
+    size_t GetSize() const {
+        return fTail.load(std::memory_order_acquire) - fHead.load(std::memory_order_acquire);
+    }
+
+    /// Returns the maximum number of elements in the queue
+    size_t GetCapacity() const { return fData.size(); }
+
+    /// The capacity is rounded up to a power of two
+    explicit TRestLegacyRingBuffer(size_t capacity)
+        : fData(RoundCapacity(capacity)), fMask(RoundCapacity(capacity) - 1) {}
+
+    TRestLegacyRingBuffer(const TRestLegacyRingBuffer&) = delete;
+    TRestLegacyRingBuffer& operator=(const TRestLegacyRingBuffer&) = delete;
+};
+#endif
@@ -0,0 +1,265 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacySignalGenerator produces synthetic raw signal events, used to
+/// benchmark and to validate the replay of the legacy zero suppression
+/// without the real data files.
+///
+/// Each channel is made of a baseline, that changes from channel to
+/// channel, gaussian noise, noise shared by groups of consecutive channels,
+/// and a random number of pulses following a Poisson distribution, so that
+/// pulses pile up as the occupancy grows. The pulses have the shape of a
+/// semi-gaussian shaper, \f$ A (t/\tau)^3 e^{3 (1 - t/\tau)} \f$, whose
+/// maximum is reached `fShapingTime` samples after the start of the pulse.
+/// The samples are saturated at `fADCMax`, producing the flat tops of the
+/// largest pulses. A fraction of dead channels stay at their baseline
+/// without any noise.
+///
+/// The events are fully determined by the seed and the event number. Each
+/// channel has its own random sequence derived from both of them, so that
+/// events can be generated in any order, or in parallel with a generator
+/// per thread, with the same result.
+///
+/// The generator is designed not to be the bottleneck of a benchmark. The
+/// random numbers come from a splitmix64 sequence, and each 64-bit number
+/// provides the gaussian noise of four samples, taken from a table of
+/// kGaussianTable deviates at evenly spaced quantiles. The noise is
+/// therefore truncated at about 4.3 standard deviations. The coherent
+/// noise is taken from the same table. The pulse shape is tabulated as
+/// well, up to ten shaping times. The fastest way to use the generator is
+/// to fill a TRestRawChannelMatrix directly.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacySignalGenerator
+///
+/// <hr>
+///
+
+#include "TRestLegacySignalGenerator.h"
+
+#include <TRestRawSignalEvent.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/// It advances a splitmix64 sequence, returning its next number
+inline ULong64_t SplitMix64(ULong64_t& state) {
+    ULong64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/// Returns a number uniformly distributed in [0, 1)
+inline Double_t Uniform(ULong64_t& state) { return (SplitMix64(state) >> 11) * 0x1.0p-53; }
+
+/// Returns a gaussian deviate, by the Box-Muller transform
+inline Double_t Gaussian(ULong64_t& state) {
+    const Double_t u = 1 - Uniform(state);
+    return std::sqrt(-2 * std::log(u)) * std::cos(2 * M_PI * Uniform(state));
+}
+
+/// Returns a number of the Poisson distribution with the given mean
+inline Int_t Poisson(ULong64_t& state, Double_t mean) {
+    const Double_t limit = std::exp(-mean);
+    Int_t n = 0;
+    for (Double_t product = Uniform(state); product > limit; product *= Uniform(state)) n++;
+    return n;
+}
+
+/// Returns a seed derived from two numbers
+inline ULong64_t Mix(ULong64_t a, ULong64_t b) {
+    ULong64_t state = a ^ (b * 0xD6E8FEB86659FD93ULL);
+    return SplitMix64(state);
+}
+
+/// The number of samples converted at once
+constexpr Int_t kBlock = TRestRawChannelMatrix::kBlockSamples;
+
+/// The number of shaping times after which the pulse shape is neglected, when it is below 1e-9
+constexpr Double_t kShapingTimes = 10;
+
+/// It rounds `value` to the nearest sample, saturated at `adcMax`. The value is shifted to be positive,
+/// so that the rounding is done by a truncation.
+inline Short_t ToSample(Float_t value, Float_t adcMax) {
+    const Float_t saturated = std::min(std::max(value, -32768.f), adcMax);
+    return (Short_t)((Int_t)(saturated + 32768.5f) - 32768);
+}
+
+/// The inverse of the gaussian cumulative distribution, by bisection of std::erfc
+Double_t GaussianQuantile(Double_t p) {
+    Double_t low = -10;
+    Double_t high = 10;
+    for (int n = 0; n < 100; n++) {
+        const Double_t middle = (low + high) / 2;
+        if (0.5 * std::erfc(-middle / M_SQRT2) < p)
+            low = middle;
+        else
+            high = middle;
+    }
+    return (low + high) / 2;
+}
+
+}  // namespace
+
+TRestLegacySignalGenerator::TRestLegacySignalGenerator(const Parameters& parameters)
+    : fParameters(parameters) {
+    fParameters.fNSamples = std::max(fParameters.fNSamples, 1);
+    fParameters.fCoherentChannels = std::max(fParameters.fCoherentChannels, 1);
+
+    const Double_t shapingTime = std::max(fParameters.fShapingTime, 1e-3);
+    fShape.resize(std::min(fParameters.fNSamples, (Int_t)std::ceil(kShapingTimes * shapingTime)));
+    for (size_t i = 0; i < fShape.size(); i++) {
+        const Double_t t = i / shapingTime;
+        fShape[i] = (Float_t)(t * t * t * std::exp(3 * (1 - t)));
+    }
+
+    fGaussian.resize(kGaussianTable);
+    for (Int_t k = 0; k < kGaussianTable / 2; k++) {
+        const Float_t deviate = (Float_t)GaussianQuantile((k + 0.5) / kGaussianTable);
+        fGaussian[k] = deviate;
+        fGaussian[kGaussianTable - 1 - k] = -deviate;
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief Returns true if the given channel is dead. The dead channels are
+/// the same in all the events.
+///
+Bool_t TRestLegacySignalGenerator::IsDead(Int_t channel) const {
+    ULong64_t state = Mix(fParameters.fSeed, ~(ULong64_t)channel);
+    return Uniform(state) < fParameters.fDeadFraction;
+}
+
+///////////////////////////////////////////////
+/// \brief It generates the given event in `matrix`, whose channels have the
+/// signal ids 0, 1, 2...
+///
+void TRestLegacySignalGenerator::Generate(ULong64_t event, TRestRawChannelMatrix& matrix) {
+    const Int_t nChannels = fParameters.fNChannels;
+    const Int_t nSamples = fParameters.fNSamples;
+    const ULong64_t seed = Mix(fParameters.fSeed, event);
+
+    matrix.Resize(nChannels, nSamples);
+    fCoherent.assign(matrix.GetStride(), 0);
+    for (Int_t c = 0; c < nChannels; c++) {
+        // The coherent noise is shared by the channels of a group
+        if (c % fParameters.fCoherentChannels == 0 && fParameters.fCoherentNoise > 0) {
+            ULong64_t state = Mix(seed, ~(ULong64_t)c);
+            const Float_t noise = (Float_t)fParameters.fCoherentNoise;
+            for (auto& value : fCoherent) value = noise * fGaussian[SplitMix64(state) & 0xFFFF];
+        }
+
+        Short_t* row = matrix.GetRow(c);
+        matrix.SetChannel(c, c, nSamples);
+        GenerateChannel(seed, c, row);
+        std::fill(row + nSamples, row + matrix.GetStride(), 0);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It generates the given event in `rawEvent`, whose signals have the
+/// ids 0, 1, 2...
+///
+void TRestLegacySignalGenerator::Generate(ULong64_t event, TRestRawSignalEvent* rawEvent) {
+    TRestRawChannelMatrix matrix;
+    Generate(event, matrix);
+
+    rawEvent->Initialize();
+    rawEvent->SetID((Int_t)event);
+    for (Int_t c = 0; c < matrix.GetNumberOfChannels(); c++) {
+        TRestRawSignal signal;
+        signal.SetSignalID(matrix.GetSignalID(c));
+        const Short_t* row = matrix.GetRow(c);
+        for (Int_t i = 0; i < matrix.GetNumberOfSamples(c); i++) signal.AddPoint(row[i]);
+        rawEvent->AddSignal(signal);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It generates the samples of one channel of the event with the given
+/// seed. The coherent noise of its group must be already generated.
+///
+/// The samples are written up to the next multiple of the matrix blocks,
+/// and the samples after `fNSamples` must be overwritten afterwards.
+///
+void TRestLegacySignalGenerator::GenerateChannel(ULong64_t seed, Int_t channel, Short_t* samples) {
+    const Int_t nSamples = fParameters.fNSamples;
+    ULong64_t state = Mix(seed, channel);
+
+    // The baseline of a channel is the same in all the events
+    ULong64_t baseLineState = Mix(fParameters.fSeed, channel);
+    const Double_t baseLineSpread = fParameters.fBaseLineSpread * Gaussian(baseLineState);
+    const Float_t baseLine = (Float_t)(fParameters.fBaseLine + baseLineSpread);
+    const Float_t adcMax = (Float_t)std::min(fParameters.fADCMax, 32767);
+
+    if (IsDead(channel)) {
+        std::fill(samples, samples + nSamples, ToSample(baseLine, adcMax));
+        return;
+    }
+
+    // The samples are converted in blocks of a fixed size, that the compiler vectorizes. The rows of
+    // the matrix have room for them.
+    const Int_t nBlocks = (nSamples + kBlock - 1) / kBlock;
+    fBuffer.resize(nBlocks * kBlock);
+    Float_t* buffer = fBuffer.data();
+    const Float_t* gaussian = fGaussian.data();
+    const Float_t* coherent = fCoherent.data();
+    const Float_t noise = (Float_t)fParameters.fNoise;
+
+    // Each random number gives the noise of four samples
+    Int_t i = 0;
+    for (; i + 4 <= nSamples; i += 4) {
+        const ULong64_t bits = SplitMix64(state);
+        buffer[i] = baseLine + coherent[i] + noise * gaussian[bits & 0xFFFF];
+        buffer[i + 1] = baseLine + coherent[i + 1] + noise * gaussian[(bits >> 16) & 0xFFFF];
+        buffer[i + 2] = baseLine + coherent[i + 2] + noise * gaussian[(bits >> 32) & 0xFFFF];
+        buffer[i + 3] = baseLine + coherent[i + 3] + noise * gaussian[bits >> 48];
+    }
+    if (i < nSamples) {
+        const ULong64_t bits = SplitMix64(state);
+        for (; i < nSamples; i++)
+            buffer[i] = baseLine + coherent[i] + noise * gaussian[(bits >> (16 * (i % 4))) & 0xFFFF];
+    }
+
+    // The pulse shape is tabulated up to the point where it is negligible
+    const Int_t nPulses = Poisson(state, fParameters.fOccupancy);
+    for (Int_t p = 0; p < nPulses; p++) {
+        const Int_t start = (Int_t)(Uniform(state) * nSamples);
+        const Int_t end = std::min(nSamples, start + (Int_t)fShape.size());
+        const Double_t range = fParameters.fAmplitudeMax - fParameters.fAmplitudeMin;
+        const Float_t amplitude = (Float_t)(fParameters.fAmplitudeMin + range * Uniform(state));
+        const Float_t* shape = fShape.data();
+        for (i = 0; i < end - start; i++) buffer[start + i] += amplitude * shape[i];
+    }
+
+    std::fill(buffer + nSamples, buffer + nBlocks * kBlock, 0);
+
+    for (Int_t b = 0; b < nBlocks * kBlock; b += kBlock)
+        for (Int_t k = 0; k < kBlock; k++) samples[b + k] = ToSample(buffer[b + k], adcMax);
+}
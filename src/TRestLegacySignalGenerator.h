@@ -0,0 +1,104 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacySignalGenerator
+#define RestCore_TRestLegacySignalGenerator
+
+#include <Rtypes.h>
+
+#include <vector>
+
+#include "TRestRawChannelMatrix.h"
+
+class TRestRawSignalEvent;
+
+//! A deterministic generator of synthetic raw signal events
+class TRestLegacySignalGenerator {
+   public:
+    /// The description of the generated events
+    struct Parameters {
+        /// The number of channels of each event
+        Int_t fNChannels = 2048;
+
+        /// The number of samples of each channel
+        Int_t fNSamples = 512;
+
+        /// The mean baseline of the channels, and the spread of the baselines of different channels
+        Double_t fBaseLine = 250;
+        Double_t fBaseLineSpread = 20;
+
+        /// The standard deviation of the gaussian noise of each sample
+        Double_t fNoise = 5;
+
+        /// The standard deviation of the noise shared by each group of fCoherentChannels channels
+        Double_t fCoherentNoise = 0;
+        Int_t fCoherentChannels = 64;
+
+        /// The mean number of pulses in each channel. Several pulses in a channel may pile up.
+        Double_t fOccupancy = 0.05;
+
+        /// The range of the pulse amplitudes, over the baseline
+        Double_t fAmplitudeMin = 100;
+        Double_t fAmplitudeMax = 2000;
+
+        /// The number of samples from the start of a pulse to its maximum
+        Double_t fShapingTime = 20;
+
+        /// The fraction of dead channels, that stay at their baseline without any noise
+        Double_t fDeadFraction = 0;
+
+        /// The largest value of the ADC. The samples are saturated at this value.
+        Int_t fADCMax = 4095;
+
+        /// The seed defining all the generated events
+        ULong64_t fSeed = 1;
+    };
+
+    /// The number of entries of the table of gaussian deviates
+    static constexpr Int_t kGaussianTable = 1 << 16;
+
+   private:
+    Parameters fParameters;
+
+    /// The normalized pulse shape, sampled at each bin from the start of the pulse
+    std::vector<Float_t> fShape;
+
+    /// Gaussian deviates with unit standard deviation, at evenly spaced quantiles
+    std::vector<Float_t> fGaussian;
+
+    /// Scratch buffers with the samples of one channel and the coherent noise of one group
+    std::vector<Float_t> fBuffer;
+    std::vector<Float_t> fCoherent;
+
+    Bool_t IsDead(Int_t channel) const;
+    void GenerateChannel(ULong64_t seed, Int_t channel, Short_t* samples);
+
+   public:
+    void Generate(ULong64_t event, TRestRawChannelMatrix& matrix);
+    void Generate(ULong64_t event, TRestRawSignalEvent* rawEvent);
+
+    /// Returns the parameters describing the generated events
+    const Parameters& GetParameters() const { return fParameters; }
+
+    explicit TRestLegacySignalGenerator(const Parameters& parameters);
+};
+#endif
@@ -0,0 +1,135 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestLegacyThreadPool keeps a set of threads alive to execute jobs made
+/// of independent tasks, i.e. the chunks of channels of an event replayed
+/// by TRestRawZeroSuppresionKernel. The thread calling Run takes part in
+/// the job, so that a pool of N threads creates N - 1 workers.
+///
+/// The tasks of a job are split in contiguous ranges, one per thread. Each
+/// thread takes tasks from its own range, and when it is exhausted it
+/// steals the pending tasks of the other ranges. The tasks are claimed with
+/// an atomic counter per range, so that each task is executed exactly once
+/// no matter which thread runs it.
+///
+/// The pool does not impose any order in the execution of the tasks. The
+/// callers keep their results deterministic by writing the output of each
+/// task to its own slot, and merging the slots in order once Run returns.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestLegacyThreadPool
+///
+/// <hr>
+///
+
+#include "TRestLegacyThreadPool.h"
+
+#include <algorithm>
+
+TRestLegacyThreadPool::TRestLegacyThreadPool(Int_t nThreads)
+    : fNThreads(std::max(nThreads, 1)), fRanges(new Range[std::max(nThreads, 1)]) {
+    for (Int_t t = 1; t < fNThreads; t++) fWorkers.emplace_back(&TRestLegacyThreadPool::WorkerLoop, this, t);
+}
+
+TRestLegacyThreadPool::~TRestLegacyThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStop = true;
+    }
+    fStart.notify_all();
+    for (auto& worker : fWorkers) worker.join();
+}
+
+///////////////////////////////////////////////
+/// \brief It executes `task` for each task index in [0, nTasks), and it returns
+/// when all of them are finished.
+///
+/// If a task throws an exception, the remaining tasks are still executed
+/// and the first exception is rethrown here.
+///
+void TRestLegacyThreadPool::Run(size_t nTasks, const Task& task) {
+    if (nTasks == 0) return;
+
+    if (fNThreads == 1) {
+        for (size_t i = 0; i < nTasks; i++) task(i, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        for (Int_t t = 0; t < fNThreads; t++) {
+            fRanges[t].fNext.store(nTasks * t / fNThreads, std::memory_order_relaxed);
+            fRanges[t].fEnd = nTasks * (t + 1) / fNThreads;
+        }
+        fTask = &task;
+        fException = nullptr;
+        fPending = fNThreads - 1;
+        fGeneration++;
+    }
+    fStart.notify_all();
+
+    Work(0);
+
+    std::unique_lock<std::mutex> lock(fMutex);
+    fDone.wait(lock, [this] { return fPending == 0; });
+    fTask = nullptr;
+    if (fException) std::rethrow_exception(fException);
+}
+
+///////////////////////////////////////////////
+/// \brief It executes the tasks of the own range, and then it steals the
+/// pending tasks of the other threads.
+///
+void TRestLegacyThreadPool::Work(Int_t thread) {
+    for (Int_t k = 0; k < fNThreads; k++) {
+        Range& range = fRanges[(thread + k) % fNThreads];
+        for (size_t i = range.fNext.fetch_add(1, std::memory_order_relaxed); i < range.fEnd;
+             i = range.fNext.fetch_add(1, std::memory_order_relaxed)) {
+            try {
+                (*fTask)(i, thread);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(fMutex);
+                if (!fException) fException = std::current_exception();
+            }
+        }
+    }
+}
+
+void TRestLegacyThreadPool::WorkerLoop(Int_t thread) {
+    size_t generation = 0;
+    std::unique_lock<std::mutex> lock(fMutex);
+    while (true) {
+        fStart.wait(lock, [&] { return fStop || fGeneration != generation; });
+        if (fStop) return;
+        generation = fGeneration;
+
+        lock.unlock();
+        Work(thread);
+        lock.lock();
+
+        if (--fPending == 0) fDone.notify_one();
+    }
+}
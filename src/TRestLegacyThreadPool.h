@@ -0,0 +1,93 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestLegacyThreadPool
+#define RestCore_TRestLegacyThreadPool
+
+#include <Rtypes.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! A pool of threads that share the tasks of a job by work stealing
+class TRestLegacyThreadPool {
+   public:
+    /// The function executing a task, it receives the task index and the index of the thread running it
+    typedef std::function<void(size_t task, Int_t thread)> Task;
+
+   private:
+    /// The range of tasks initially assigned to one thread
+    struct alignas(64) Range {
+        std::atomic<size_t> fNext{0};
+        size_t fEnd = 0;
+    };
+
+    /// The total number of threads, including the one calling Run
+    Int_t fNThreads;
+
+    /// The worker threads
+    std::vector<std::thread> fWorkers;
+
+    /// The ranges of tasks of each thread in the current job
+    std::unique_ptr<Range[]> fRanges;
+
+    /// The function executing the tasks of the current job
+    const Task* fTask = nullptr;
+
+    /// The first exception thrown by a task of the current job
+    std::exception_ptr fException;
+
+    std::mutex fMutex;
+    std::condition_variable fStart;
+    std::condition_variable fDone;
+
+    /// It is increased for each job, so that the workers know when a new job starts
+    size_t fGeneration = 0;
+
+    /// The number of workers that did not finish the current job
+    Int_t fPending = 0;
+
+    /// It tells the workers to finish
+    bool fStop = false;
+
+    void Work(Int_t thread);
+    void WorkerLoop(Int_t thread);
+
+   public:
+    void Run(size_t nTasks, const Task& task);
+
+    /// Returns the total number of threads, including the one calling Run
+    Int_t GetNumberOfThreads() const { return fNThreads; }
+
+    explicit TRestLegacyThreadPool(Int_t nThreads);
+    TRestLegacyThreadPool(const TRestLegacyThreadPool&) = delete;
+    TRestLegacyThreadPool& operator=(const TRestLegacyThreadPool&) = delete;
+    ~TRestLegacyThreadPool();
+};
+#endif
@@ -0,0 +1,126 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestRawChannelMatrix stores the ADC samples of all the channels of a
+/// TRestRawSignalEvent in a single contiguous block of memory, with one
+/// row per channel. It is used by TRestRawZeroSuppresionKernel so that the
+/// baseline, threshold and flat tail passes stream through the samples of
+/// consecutive channels with unit stride, instead of following a pointer
+/// to each TRestRawSignal.
+///
+/// Every row starts at an address aligned to kAlignment bytes, and the
+/// stride between rows is a multiple of kBlockSamples samples. The samples
+/// between the end of a channel and the end of its row are set to zero,
+/// so that the vectorized passes can always read complete blocks.
+///
+/// Several events can be packed together, one after the other, so that
+/// they are processed as a single batch of channels. The memory is reused
+/// from one event to the next one, and it is only reallocated when a
+/// larger event, or batch, is packed.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestRawChannelMatrix
+///
+/// <hr>
+///
+
+#include "TRestRawChannelMatrix.h"
+
+#include <TRestRawSignalEvent.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+TRestRawChannelMatrix::~TRestRawChannelMatrix() { free(fData); }
+
+///////////////////////////////////////////////
+/// \brief It prepares the matrix to store `nChannels` channels with up to
+/// `maxSamples` samples each. The previous content is not preserved.
+///
+void TRestRawChannelMatrix::Resize(Int_t nChannels, Int_t maxSamples) {
+    fNChannels = nChannels;
+    fStride = (maxSamples + kBlockSamples - 1) / kBlockSamples * kBlockSamples;
+    fNSamples.assign(nChannels, 0);
+    fSignalIDs.assign(nChannels, 0);
+    fEventFirstChannel.assign({0, nChannels});
+
+    const size_t size = (size_t)nChannels * fStride;
+    if (size <= fCapacity) return;
+
+    free(fData);
+    fData = (Short_t*)aligned_alloc(kAlignment, size * sizeof(Short_t));
+    if (fData == nullptr) {
+        fCapacity = 0;
+        throw std::bad_alloc();
+    }
+    fCapacity = size;
+}
+
+///////////////////////////////////////////////
+/// \brief It copies the samples of all the signals of `event` to the matrix
+///
+void TRestRawChannelMatrix::Pack(TRestRawSignalEvent* event) { Pack(&event, 1); }
+
+///////////////////////////////////////////////
+/// \brief It copies the samples of all the signals of `events` to the matrix,
+/// one event after the other.
+///
+void TRestRawChannelMatrix::Pack(const std::vector<TRestRawSignalEvent*>& events) {
+    Pack(events.data(), events.size());
+}
+
+void TRestRawChannelMatrix::Pack(TRestRawSignalEvent* const* events, size_t nEvents) {
+    Int_t nChannels = 0;
+    Int_t maxSamples = 0;
+    for (size_t e = 0; e < nEvents; e++) {
+        TRestRawSignalEvent* event = events[e];
+        for (Int_t c = 0; c < event->GetNumberOfSignals(); c++)
+            maxSamples = std::max(maxSamples, event->GetSignal(c)->GetNumberOfPoints());
+        nChannels += event->GetNumberOfSignals();
+    }
+
+    Resize(nChannels, maxSamples);
+
+    fEventFirstChannel.clear();
+    Int_t channel = 0;
+    for (size_t e = 0; e < nEvents; e++) {
+        TRestRawSignalEvent* event = events[e];
+        fEventFirstChannel.push_back(channel);
+        for (Int_t n = 0; n < event->GetNumberOfSignals(); n++, channel++) {
+            TRestRawSignal* signal = event->GetSignal(n);
+            const Int_t nSamples = signal->GetNumberOfPoints();
+            fNSamples[channel] = nSamples;
+            fSignalIDs[channel] = signal->GetSignalID();
+
+            Short_t* row = GetRow(channel);
+            for (Int_t i = 0; i < nSamples; i++) row[i] = (Short_t)signal->GetRawData(i);
+            memset(row + nSamples, 0, (fStride - nSamples) * sizeof(Short_t));
+        }
+    }
+    fEventFirstChannel.push_back(channel);
+}
@@ -0,0 +1,104 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestRawChannelMatrix
+#define RestCore_TRestRawChannelMatrix
+
+#include <Rtypes.h>
+
+#include <cstddef>
+#include <vector>
+
+class TRestRawSignalEvent;
+
+//! A contiguous and aligned matrix with the ADC samples of all the channels of an event
+class TRestRawChannelMatrix {
+   public:
+    /// The alignment of the matrix rows, in bytes
+    static constexpr size_t kAlignment = 128;
+
+    /// The row stride is always a multiple of this number of samples
+    static constexpr Int_t kBlockSamples = kAlignment / sizeof(Short_t);
+
+   private:
+    /// The samples of channel `c` are stored at `fData + c * fStride`
+    Short_t* fData = nullptr;
+
+    /// The number of samples allocated at fData
+    size_t fCapacity = 0;
+
+    /// The number of channels stored in the matrix
+    Int_t fNChannels = 0;
+
+    /// The distance between consecutive rows, in samples
+    Int_t fStride = 0;
+
+    /// The number of samples of each channel
+    std::vector<Int_t> fNSamples;
+
+    /// The signal id of each channel
+    std::vector<Int_t> fSignalIDs;
+
+    /// The first channel of each event packed in the matrix, followed by the number of channels
+    std::vector<Int_t> fEventFirstChannel;
+
+    void Pack(TRestRawSignalEvent* const* events, size_t nEvents);
+
+   public:
+    void Resize(Int_t nChannels, Int_t maxSamples);
+    void Pack(TRestRawSignalEvent* event);
+    void Pack(const std::vector<TRestRawSignalEvent*>& events);
+
+    /// It sets the signal id and the number of samples of the given channel, once the matrix is resized
+    void SetChannel(Int_t channel, Int_t signalID, Int_t nSamples) {
+        fSignalIDs[channel] = signalID;
+        fNSamples[channel] = nSamples;
+    }
+
+    /// Returns the samples of the given channel
+    Short_t* GetRow(Int_t channel) { return fData + (size_t)channel * fStride; }
+    const Short_t* GetRow(Int_t channel) const { return fData + (size_t)channel * fStride; }
+
+    /// Returns the number of channels stored in the matrix
+    Int_t GetNumberOfChannels() const { return fNChannels; }
+
+    /// Returns the distance between consecutive rows, in samples
+    Int_t GetStride() const { return fStride; }
+
+    /// Returns the number of samples of the given channel
+    Int_t GetNumberOfSamples(Int_t channel) const { return fNSamples[channel]; }
+
+    /// Returns the signal id of the given channel
+    Int_t GetSignalID(Int_t channel) const { return fSignalIDs[channel]; }
+
+    /// Returns the number of events packed in the matrix
+    Int_t GetNumberOfEvents() const { return (Int_t)fEventFirstChannel.size() - 1; }
+
+    /// Returns the first channel of the given event, its channels end at the first one of the next event
+    Int_t GetFirstChannel(Int_t event) const { return fEventFirstChannel[event]; }
+
+    TRestRawChannelMatrix() = default;
+    TRestRawChannelMatrix(const TRestRawChannelMatrix&) = delete;
+    TRestRawChannelMatrix& operator=(const TRestRawChannelMatrix&) = delete;
+    ~TRestRawChannelMatrix();
+};
+#endif
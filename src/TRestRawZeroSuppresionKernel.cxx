@@ -0,0 +1,556 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestRawZeroSuppresionKernel implements the zero suppression of the
+/// legacy TRestRawZeroSuppresionProcess, and it is used to replay the
+/// persisted parameters of that process. It works directly on the ADC
+/// samples of each channel, without creating intermediate signal objects.
+///
+/// For each channel the baseline and its fluctuation are calculated as the
+/// mean and the standard deviation of the samples inside the baseline
+/// range. Then, inside the integral range, consecutive points that are
+/// more than `fPointThreshold` sigmas over the baseline define a pulse.
+/// A pulse is artificially ended after `fNPointsFlatThreshold` consecutive
+/// points where the signal does not change more than the point threshold,
+/// and the point ending the flat tail is discarded. A pulse is accepted if
+/// it has at least `fNPointsOverThreshold` points, and if the standard
+/// deviation of its points is over `fSignalThreshold` sigmas.
+///
+/// The standard deviation of a pulse is the population one, dividing by
+/// the number of points, as computed by the last version of
+/// TRestRawSignal::InitializePointsOverThreshold used by the legacy
+/// process, and by TRestRawToDetectorSignalProcess. Earlier versions used
+/// TMath::StdDev, that divides by the number of points minus one. Data
+/// processed with them may keep pulses whose deviation is up to a factor
+/// sqrt(n / (n - 1)) below the signal threshold, that the replay rejects.
+///
+/// The samples of an event are first packed into a TRestRawChannelMatrix,
+/// and the baseline of several channels is calculated at once by the
+/// vectorized kernel at TRestRawZeroSuppresionSIMD. The channels of large
+/// events can be shared by several threads, see SetNumberOfThreads. The
+/// channels with the most common number of samples are processed by code
+/// specialized at compile time, see SetSpecialization. The sums involved
+/// in the baseline and in the pulse standard deviation are accumulated
+/// exactly in integer arithmetic, so that the result does not depend on
+/// the order of the operations. The differences between consecutive
+/// points are also evaluated exactly on the raw ADC values.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestRawZeroSuppresionKernel
+///
+/// <hr>
+///
+
+#include "TRestRawZeroSuppresionKernel.h"
+
+#include <TRestDetectorSignalEvent.h>
+#include <TRestRawSignalEvent.h>
+
+#include "TRestRawZeroSuppresionSIMD.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+/// Returns the position of the first bit set in [from, to), or `to` if there is none
+inline Int_t NextSetBit(const ULong64_t* mask, Int_t from, Int_t to) {
+    if (from >= to) return to;
+    const Int_t nWords = (to + 63) / 64;
+    Int_t w = from / 64;
+    ULong64_t bits = mask[w] & (~0ULL << (from % 64));
+    while (bits == 0) {
+        if (++w >= nWords) return to;
+        bits = mask[w];
+    }
+    return std::min(64 * w + __builtin_ctzll(bits), to);
+}
+
+/// Returns the position of the first bit cleared in [from, to), or `to` if there is none
+inline Int_t NextClearBit(const ULong64_t* mask, Int_t from, Int_t to) {
+    if (from >= to) return to;
+    const Int_t nWords = (to + 63) / 64;
+    Int_t w = from / 64;
+    ULong64_t bits = ~mask[w] & (~0ULL << (from % 64));
+    while (bits == 0) {
+        if (++w >= nWords) return to;
+        bits = ~mask[w];
+    }
+    return std::min(64 * w + __builtin_ctzll(bits), to);
+}
+
+inline Int_t CountBits(const ULong64_t* mask, Int_t nWords) {
+    Int_t count = 0;
+    for (Int_t w = 0; w < nWords; w++) count += __builtin_popcountll(mask[w]);
+    return count;
+}
+
+/// Returns the 64 bits of the mask starting at bit `position`, with zeros beyond the mask end
+inline ULong64_t ReadBits(const ULong64_t* mask, Int_t nWords, Int_t position) {
+    const Int_t w = position / 64;
+    const Int_t shift = position % 64;
+    const ULong64_t low = w < nWords ? mask[w] : 0;
+    if (shift == 0) return low;
+    const ULong64_t high = w + 1 < nWords ? mask[w + 1] : 0;
+    return low >> shift | high << (64 - shift);
+}
+
+/// It sets in `starts` the bits where `length` consecutive bits of `mask` start. The runs are
+/// found by a cascade of shifts and ANDs, that doubles the length covered at each step.
+void RunStarts(const ULong64_t* mask, Int_t nWords, Int_t length, ULong64_t* starts) {
+    std::copy(mask, mask + nWords, starts);
+    for (Int_t covered = 1; covered < length;) {
+        const Int_t shift = std::min(covered, length - covered);
+        for (Int_t w = 0; w < nWords; w++) starts[w] &= ReadBits(starts, nWords, 64 * w + shift);
+        covered += shift;
+    }
+}
+
+/// The cascade of RunStarts, unrolled for a run length known at compile time
+template <Int_t Length, Int_t Covered = 1>
+inline void RunStartsCascade(Int_t nWords, ULong64_t* starts) {
+    if constexpr (Covered < Length) {
+        constexpr Int_t shift = Covered < Length - Covered ? Covered : Length - Covered;
+        for (Int_t w = 0; w < nWords; w++) starts[w] &= ReadBits(starts, nWords, 64 * w + shift);
+        RunStartsCascade<Length, Covered + shift>(nWords, starts);
+    }
+}
+
+/// Returns the population standard deviation of the samples in [from, to), accumulating the sums
+/// exactly
+inline Double_t PulseSigma(const Short_t* samples, Int_t from, Int_t to) {
+    Long64_t sum = 0;
+    Long64_t sumSquares = 0;
+    for (Int_t j = from; j < to; j++) {
+        sum += samples[j];
+        sumSquares += (Long64_t)samples[j] * samples[j];
+    }
+    const Long64_t n = to - from;
+    return std::sqrt((Double_t)(n * sumSquares - sum * sum)) / n;
+}
+
+}  // namespace
+
+TRestRawZeroSuppresionKernel::TRestRawZeroSuppresionKernel(const Parameters& parameters, Int_t nThreads)
+    : fParameters(parameters) {
+    SetNumberOfThreads(nThreads);
+    SetSpecialization(true);
+}
+
+///////////////////////////////////////////////
+/// \brief It sets the number of threads sharing the channels of an event.
+/// A single thread processes the events serially, without any pool.
+///
+void TRestRawZeroSuppresionKernel::SetNumberOfThreads(Int_t nThreads) {
+    nThreads = std::max(nThreads, 1);
+    if (nThreads == GetNumberOfThreads()) return;
+
+    fThreadPool.reset(nThreads > 1 ? new TRestLegacyThreadPool(nThreads) : nullptr);
+    fWorkspaces.resize(nThreads);
+}
+
+///////////////////////////////////////////////
+/// \brief It enables or disables the compile-time specializations of
+/// FindPoints. They are enabled by default.
+///
+/// The specializations cover channels with kFixedSamples samples, and a
+/// fNPointsOverThreshold up to kMaxFixedPointsOver. A specialization is
+/// selected from the parameters of the kernel, and the channels of other
+/// lengths, or any other parameters, use the generic implementation. Both
+/// give exactly the same points.
+///
+void TRestRawZeroSuppresionKernel::SetSpecialization(Bool_t enable) {
+    constexpr Int_t kFixedWords = kFixedSamples / 64;
+    static const FindPointsFunction fixed[kMaxFixedPointsOver] = {
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 1>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 2>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 3>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 4>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 5>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 6>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 7>,
+        &TRestRawZeroSuppresionKernel::FindPointsImpl<kFixedWords, 8>};
+
+    const Int_t nPointsOver = std::max(fParameters.fNPointsOverThreshold, 1);
+    fFindPointsFixed = enable && nPointsOver <= kMaxFixedPointsOver ? fixed[nPointsOver - 1] : nullptr;
+}
+
+///////////////////////////////////////////////
+/// \brief It translates the point threshold of a channel, given its baseline,
+/// into integer thresholds that are compared directly with the ADC samples.
+///
+/// A sample `r` is over threshold when `r - baseLine > threshold`, evaluated
+/// in double precision. Since the rounding of the subtraction is monotonic,
+/// this condition is false up to some integer value of `r`, and true from
+/// there on. That value is found by bisection over the range of the
+/// samples, evaluating the condition exactly as the legacy process, so that
+/// `r > fPoint` holds for exactly the same samples. It is -32769 if all the
+/// samples are over threshold, and 32767 if none is, i.e. if the baseline
+/// fluctuation is not a number.
+///
+/// The difference between two samples is an integer, that is compared
+/// exactly with the threshold. Therefore, it is within the threshold if it
+/// is not larger than the integer part of the threshold, `fFlat`. It is -1
+/// if no difference is within the threshold, and 65535 if all of them are,
+/// as it happens if the threshold is not a number.
+///
+TRestRawZeroSuppresionKernel::Thresholds TRestRawZeroSuppresionKernel::IntegerThresholds(
+    Double_t baseLine, Double_t baseLineSigma) const {
+    const Double_t threshold = fParameters.fPointThreshold * baseLineSigma;
+    auto over = [&](Int_t r) { return r - baseLine > threshold; };
+
+    Thresholds thresholds;
+    Int_t low = -32769;
+    Int_t high = 32767;
+    if (!over(high)) {
+        low = high;
+    } else {
+        // The condition is always true at `high`, and false at `low` unless it is -32769
+        while (high - low > 1) {
+            const Int_t middle = low + (high - low) / 2;
+            if (over(middle))
+                high = middle;
+            else
+                low = middle;
+        }
+    }
+    thresholds.fPoint = low;
+    if (threshold < 0)
+        thresholds.fFlat = -1;
+    else if (threshold < 65535)
+        thresholds.fFlat = (Int_t)std::floor(threshold);
+    else
+        thresholds.fFlat = 65535;
+    return thresholds;
+}
+
+///////////////////////////////////////////////
+/// \brief It calls the specialization of FindPoints matching the channel, if
+/// there is any, or the generic implementation otherwise.
+///
+void TRestRawZeroSuppresionKernel::FindChannelPoints(const Short_t* samples, Int_t nSamples,
+                                                     Double_t baseLine, Double_t baseLineSigma,
+                                                     Points& points, Workspace& workspace) const {
+    if (fFindPointsFixed != nullptr && nSamples == kFixedSamples)
+        (this->*fFindPointsFixed)(samples, nSamples, baseLine, baseLineSigma, points, workspace);
+    else
+        FindPoints(samples, nSamples, baseLine, baseLineSigma, points, workspace);
+}
+
+///////////////////////////////////////////////
+/// \brief It calculates the baseline and the baseline fluctuation of the samples
+/// inside the baseline range. Both are set to zero if the range is empty.
+///
+void TRestRawZeroSuppresionKernel::BaseLine(const Short_t* samples, Int_t nSamples, Double_t& baseLine,
+                                            Double_t& baseLineSigma) const {
+    const Int_t from = std::max(fParameters.fBaseLineStart, 0);
+    const Int_t to = std::min(fParameters.fBaseLineEnd, nSamples);
+    TRestRawZeroSuppresionSIMD::BaseLine(samples, nSamples, 1, from, to, &baseLine, &baseLineSigma);
+}
+
+///////////////////////////////////////////////
+/// \brief It appends to `points` the samples of one channel that survive the
+/// zero suppression, with the baseline subtracted.
+///
+/// It releases the points found by the previous call to ProcessChannels.
+///
+void TRestRawZeroSuppresionKernel::ProcessChannel(const Short_t* samples, Int_t nSamples,
+                                                  std::vector<Point>& points) {
+    Double_t baseLine;
+    Double_t baseLineSigma;
+    BaseLine(samples, nSamples, baseLine, baseLineSigma);
+
+    Workspace& workspace = fWorkspaces[0];
+    workspace.fArena.Reset();
+    Points channelPoints;
+    FindChannelPoints(samples, nSamples, baseLine, baseLineSigma, channelPoints, workspace);
+    points.insert(points.end(), channelPoints.fData, channelPoints.fData + channelPoints.fSize);
+}
+
+///////////////////////////////////////////////
+/// \brief It sets in `points` the samples of one channel that survive the
+/// zero suppression, given the baseline of the channel. The points are
+/// allocated in the arena of `workspace`.
+///
+/// The point threshold is first translated into integer thresholds, see
+/// IntegerThresholds, and the samples over threshold are identified as a
+/// bit mask comparing directly the 16-bit samples. The
+/// positions where at least `fNPointsOverThreshold` consecutive samples over
+/// threshold start are then obtained with a cascade of shifts and ANDs on
+/// the mask, so that the pulses that are too short are skipped without
+/// visiting their samples. The flat tails are identified in the same way,
+/// so that the end of each pulse is found without walking through it.
+///
+void TRestRawZeroSuppresionKernel::FindPoints(const Short_t* samples, Int_t nSamples, Double_t baseLine,
+                                              Double_t baseLineSigma, Points& points,
+                                              Workspace& workspace) const {
+    FindPointsImpl<0, 0>(samples, nSamples, baseLine, baseLineSigma, points, workspace);
+}
+
+///////////////////////////////////////////////
+/// \brief The implementation of FindPoints. A non-zero `NWords` fixes the
+/// number of words of the masks, and it requires channels of 64 * NWords
+/// samples. A non-zero `NPointsOver` fixes the value of fNPointsOverThreshold.
+///
+/// With both of them known at compile time the loops on the masks have a
+/// fixed trip count, and the cascade identifying the pulses is unrolled.
+///
+template <Int_t NWords, Int_t NPointsOver>
+void TRestRawZeroSuppresionKernel::FindPointsImpl(const Short_t* samples, Int_t nSamples, Double_t baseLine,
+                                                  Double_t baseLineSigma, Points& points,
+                                                  Workspace& workspace) const {
+    points = Points();
+
+    const Int_t from = std::max(fParameters.fIntegralStart, 0);
+    Int_t to = fParameters.fIntegralEnd;
+    if (to <= 0 || to > nSamples) to = nSamples;
+    if (from >= to) return;
+
+    const Thresholds thresholds = IntegerThresholds(baseLine, baseLineSigma);
+    const Double_t signalThreshold = fParameters.fSignalThreshold * baseLineSigma;
+    const Int_t nPointsOver = NPointsOver > 0 ? NPointsOver : std::max(fParameters.fNPointsOverThreshold, 1);
+
+    // With a fixed number of words, the words after the integral range are cleared
+    const Int_t firstWord = from / 64;
+    const Int_t lastWord = (to + 63) / 64;
+    const Int_t nWords = NWords > 0 ? NWords : lastWord;
+    workspace.fOverThreshold.resize(nWords);
+    workspace.fPulseStarts.resize(nWords);
+    ULong64_t* overThreshold = workspace.fOverThreshold.data();
+    ULong64_t* pulseStarts = workspace.fPulseStarts.data();
+
+    std::fill(overThreshold, overThreshold + firstWord, 0);
+    std::fill(overThreshold + lastWord, overThreshold + nWords, 0);
+    TRestRawZeroSuppresionSIMD::OverThresholdMask(samples + 64 * firstWord, to - 64 * firstWord,
+                                                  thresholds.fPoint, overThreshold + firstWord);
+    overThreshold[firstWord] &= ~0ULL << (from % 64);
+
+    if (CountBits(overThreshold, nWords) < nPointsOver) return;
+    if constexpr (NPointsOver > 0) {
+        std::copy(overThreshold, overThreshold + nWords, pulseStarts);
+        RunStartsCascade<NPointsOver>(nWords, pulseStarts);
+    } else {
+        RunStarts(overThreshold, nWords, nPointsOver, pulseStarts);
+    }
+    if (NextSetBit(pulseStarts, from, to) >= to) return;
+
+    // A pulse ending in a flat tail is ended at the first sample completing fNPointsFlatThreshold
+    // consecutive samples that differ from the previous one at most the threshold. The positions
+    // where these flat tails start are identified with the same cascade used for the pulses.
+    const Int_t nPointsFlat = fParameters.fNPointsFlatThreshold;
+    ULong64_t* flatStarts = nullptr;
+    if (nPointsFlat > 0) {
+        workspace.fFlat.resize(nWords);
+        workspace.fFlatStarts.resize(nWords);
+        ULong64_t* flat = workspace.fFlat.data();
+        flatStarts = workspace.fFlatStarts.data();
+
+        std::fill(flat, flat + firstWord, 0);
+        std::fill(flat + lastWord, flat + nWords, 0);
+        TRestRawZeroSuppresionSIMD::FlatMask(samples + 64 * firstWord, to - 64 * firstWord, thresholds.fFlat,
+                                             flat + firstWord);
+        RunStarts(flat, nWords, nPointsFlat, flatStarts);
+    }
+
+    for (Int_t start = NextSetBit(pulseStarts, from, to); start < to;) {
+        Int_t end = NextClearBit(overThreshold, start + 1, to);
+        if (nPointsFlat <= 0)
+            end = std::min(end, start + 1);
+        else
+            end = std::min(end, NextSetBit(flatStarts, start + 1, to) + nPointsFlat - 1);
+
+        if (end - start >= nPointsOver && PulseSigma(samples, start, end) > signalThreshold) {
+            // The points of a channel are kept contiguous in the arena
+            points.fData = workspace.fArena.Grow(points.fData, points.fSize, end - start);
+            for (Int_t j = start; j < end; j++) points.fData[points.fSize++] = {j, samples[j] - baseLine};
+        }
+
+        // The point ending a flat tail is not considered for the next pulse
+        start = NextSetBit(pulseStarts, end + 1, to);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief A straightforward implementation of FindPoints, that walks through
+/// the samples one by one. It is kept as a reference to check the results
+/// of FindPoints, and it is used by TRestRawZeroSuppresionKernelTest.
+///
+void TRestRawZeroSuppresionKernel::FindPointsReference(const Short_t* samples, Int_t nSamples,
+                                                       Double_t baseLine, Double_t baseLineSigma,
+                                                       std::vector<Point>& points) const {
+    const Int_t from = std::max(fParameters.fIntegralStart, 0);
+    Int_t to = fParameters.fIntegralEnd;
+    if (to <= 0 || to > nSamples) to = nSamples;
+
+    const Double_t threshold = fParameters.fPointThreshold * baseLineSigma;
+    const Double_t signalThreshold = fParameters.fSignalThreshold * baseLineSigma;
+
+    for (Int_t i = from; i < to; i++) {
+        if (samples[i] - baseLine <= threshold) continue;
+
+        // The pulse is made of consecutive points over threshold, unless it
+        // ends in a flat tail that is still over threshold
+        const Int_t start = i++;
+        Int_t flatN = 0;
+        while (i < to && samples[i] - baseLine > threshold) {
+            if (std::abs(samples[i] - samples[i - 1]) > threshold)
+                flatN = 0;
+            else
+                flatN++;
+
+            if (flatN >= fParameters.fNPointsFlatThreshold) break;
+            i++;
+        }
+
+        if (i - start < fParameters.fNPointsOverThreshold) continue;
+
+        if (PulseSigma(samples, start, i) <= signalThreshold) continue;
+
+        for (Int_t j = start; j < i; j++) points.push_back({j, samples[j] - baseLine});
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It fills `outputEvent` with the signals of `inputEvent` that have
+/// at least one point surviving the zero suppression.
+///
+void TRestRawZeroSuppresionKernel::ProcessEvent(TRestRawSignalEvent* inputEvent,
+                                                TRestDetectorSignalEvent* outputEvent) {
+    fMatrix.Pack(inputEvent);
+    ProcessChannels(fMatrix);
+
+    outputEvent->Initialize();
+    outputEvent->SetEventInfo(inputEvent);
+    FillEvent(fMatrix, 0, fMatrix.GetNumberOfChannels(), outputEvent);
+}
+
+///////////////////////////////////////////////
+/// \brief It fills each of the `outputEvents` with the zero suppression of the
+/// corresponding event in `inputEvents`. Both vectors must have the same size.
+///
+/// The channels of all the events are packed together and shared by the
+/// threads as a single job, so that the cost of preparing the buffers and
+/// dispatching the threads is paid once per batch instead of once per
+/// event. The result is the same obtained calling ProcessEvent for each
+/// event.
+///
+void TRestRawZeroSuppresionKernel::ProcessBatch(const std::vector<TRestRawSignalEvent*>& inputEvents,
+                                                const std::vector<TRestDetectorSignalEvent*>& outputEvents) {
+    fMatrix.Pack(inputEvents);
+    ProcessChannels(fMatrix);
+
+    for (size_t n = 0; n < inputEvents.size(); n++) {
+        outputEvents[n]->Initialize();
+        outputEvents[n]->SetEventInfo(inputEvents[n]);
+        FillEvent(fMatrix, fMatrix.GetFirstChannel(n), fMatrix.GetFirstChannel(n + 1), outputEvents[n]);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It adds to `outputEvent` the signals of `matrix` that have at least
+/// one point surviving the zero suppression.
+///
+void TRestRawZeroSuppresionKernel::ProcessMatrix(const TRestRawChannelMatrix& matrix,
+                                                 TRestDetectorSignalEvent* outputEvent) {
+    ProcessChannels(matrix);
+    FillEvent(matrix, 0, matrix.GetNumberOfChannels(), outputEvent);
+}
+
+///////////////////////////////////////////////
+/// \brief It calculates the baseline and it identifies the points over
+/// threshold of all the channels in `matrix`.
+///
+/// The channels are processed in chunks of kChunkChannels, that are shared
+/// by the threads of the kernel. The result does not depend on the number
+/// of threads, since the points of each channel are stored separately and
+/// they are collected in the channel order by FillEvent.
+///
+/// The points are owned by the arenas of the threads, that are reset at
+/// the beginning of each call. Therefore, the points found by a call are
+/// only valid until the next one.
+///
+void TRestRawZeroSuppresionKernel::ProcessChannels(const TRestRawChannelMatrix& matrix) {
+    const Int_t nChannels = matrix.GetNumberOfChannels();
+    const Int_t nChunks = (nChannels + kChunkChannels - 1) / kChunkChannels;
+
+    fBaseLine.resize(nChannels);
+    fBaseLineSigma.resize(nChannels);
+    fChannelPoints.resize(nChannels);
+    for (auto& workspace : fWorkspaces) workspace.fArena.Reset();
+
+    if (fThreadPool != nullptr && nChunks > 1)
+        fThreadPool->Run(nChunks, [&](size_t chunk, Int_t thread) {
+            ProcessChunk(matrix, (Int_t)chunk, fWorkspaces[thread]);
+        });
+    else
+        for (Int_t chunk = 0; chunk < nChunks; chunk++) ProcessChunk(matrix, chunk, fWorkspaces[0]);
+}
+
+///////////////////////////////////////////////
+/// \brief It adds to `outputEvent` the channels in [first, last) of `matrix`
+/// with at least one point over threshold, as found by ProcessChannels.
+///
+/// The time of each point is given by its bin multiplied by the sampling.
+///
+void TRestRawZeroSuppresionKernel::FillEvent(const TRestRawChannelMatrix& matrix, Int_t first, Int_t last,
+                                             TRestDetectorSignalEvent* outputEvent) const {
+    for (Int_t c = first; c < last; c++) {
+        const Points& points = fChannelPoints[c];
+        if (points.fSize == 0) continue;
+
+        TRestDetectorSignal signal;
+        signal.SetSignalID(matrix.GetSignalID(c));
+        for (Int_t p = 0; p < points.fSize; p++)
+            signal.NewPoint(points.fData[p].fBin * fParameters.fSampling, points.fData[p].fData);
+        outputEvent->AddSignal(signal);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It calculates the baseline and it identifies the points over
+/// threshold of the channels in one chunk.
+///
+void TRestRawZeroSuppresionKernel::ProcessChunk(const TRestRawChannelMatrix& matrix, Int_t chunk,
+                                                Workspace& workspace) {
+    const Int_t first = chunk * kChunkChannels;
+    const Int_t last = std::min(first + kChunkChannels, matrix.GetNumberOfChannels());
+
+    // Consecutive channels with the same number of samples share the baseline range
+    for (Int_t begin = first, end = first; begin < last; begin = end) {
+        const Int_t nSamples = matrix.GetNumberOfSamples(begin);
+        while (end < last && matrix.GetNumberOfSamples(end) == nSamples) end++;
+
+        const Int_t from = std::max(fParameters.fBaseLineStart, 0);
+        const Int_t to = std::min(fParameters.fBaseLineEnd, nSamples);
+        TRestRawZeroSuppresionSIMD::BaseLine(matrix.GetRow(begin), matrix.GetStride(), end - begin, from, to,
+                                             &fBaseLine[begin], &fBaseLineSigma[begin]);
+    }
+
+    for (Int_t c = first; c < last; c++)
+        FindChannelPoints(matrix.GetRow(c), matrix.GetNumberOfSamples(c), fBaseLine[c], fBaseLineSigma[c],
+                          fChannelPoints[c], workspace);
+}
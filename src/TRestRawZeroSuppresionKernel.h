@@ -0,0 +1,174 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestRawZeroSuppresionKernel
+#define RestCore_TRestRawZeroSuppresionKernel
+
+#include <Rtypes.h>
+
+#include <memory>
+#include <vector>
+
+#include "TRestLegacyArena.h"
+#include "TRestLegacyThreadPool.h"
+#include "TRestRawChannelMatrix.h"
+
+class TRestRawSignalEvent;
+class TRestDetectorSignalEvent;
+
+//! The zero suppression algorithm of the legacy TRestRawZeroSuppresionProcess
+class TRestRawZeroSuppresionKernel {
+   public:
+    /// The persisted parameters of the legacy process, with the ranges given in bins
+    struct Parameters {
+        Int_t fBaseLineStart = 0;
+        Int_t fBaseLineEnd = 0;
+        Int_t fIntegralStart = 0;
+        Int_t fIntegralEnd = 0;
+        Double_t fPointThreshold = 0;
+        Double_t fSignalThreshold = 0;
+        Int_t fNPointsOverThreshold = 0;
+        Int_t fNPointsFlatThreshold = 0;
+        Double_t fSampling = 1;
+    };
+
+    /// A sample that survived the zero suppression, with the baseline already subtracted
+    struct Point {
+        Int_t fBin;
+        Double_t fData;
+    };
+
+    /// The points of one channel, stored in the arena of the thread that processed it
+    struct Points {
+        Point* fData = nullptr;
+        Int_t fSize = 0;
+    };
+
+    /// The point threshold of a channel translated to the integer domain of the samples
+    struct Thresholds {
+        /// The largest sample that is not over threshold
+        Int_t fPoint;
+
+        /// The largest difference between consecutive samples that is within the threshold
+        Int_t fFlat;
+    };
+
+    /// Scratch buffers used to identify the points over threshold of one channel
+    struct Workspace {
+        /// The arena owning the points found by this workspace in the current event
+        TRestLegacyArena fArena;
+
+        /// A bit mask with the samples over threshold
+        std::vector<ULong64_t> fOverThreshold;
+
+        /// A bit mask with the samples where enough consecutive samples over threshold start
+        std::vector<ULong64_t> fPulseStarts;
+
+        /// A bit mask with the samples that do not change more than the threshold
+        std::vector<ULong64_t> fFlat;
+
+        /// A bit mask with the samples where a flat tail of fNPointsFlatThreshold samples starts
+        std::vector<ULong64_t> fFlatStarts;
+    };
+
+    /// The number of consecutive channels processed by each task
+    static constexpr Int_t kChunkChannels = 32;
+
+    /// The number of samples of the channels processed by the compile-time specializations
+    static constexpr Int_t kFixedSamples = 512;
+
+    /// The largest fNPointsOverThreshold with a compile-time specialization
+    static constexpr Int_t kMaxFixedPointsOver = 8;
+
+   private:
+    /// The parameters defining the zero suppression
+    Parameters fParameters;
+
+    /// The samples of the event being processed
+    TRestRawChannelMatrix fMatrix;
+
+    /// Scratch buffers with the baseline and baseline fluctuation of each channel
+    std::vector<Double_t> fBaseLine;
+    std::vector<Double_t> fBaseLineSigma;
+
+    /// The threads sharing the channels of an event. Only used with more than one thread.
+    std::unique_ptr<TRestLegacyThreadPool> fThreadPool;
+
+    /// Scratch buffers used by FindPoints, one per thread
+    std::vector<Workspace> fWorkspaces;
+
+    /// The points identified in each channel
+    std::vector<Points> fChannelPoints;
+
+    typedef void (TRestRawZeroSuppresionKernel::*FindPointsFunction)(const Short_t*, Int_t, Double_t,
+                                                                      Double_t, Points&, Workspace&) const;
+
+    /// The specialization of FindPoints used for channels with kFixedSamples samples, if any
+    FindPointsFunction fFindPointsFixed = nullptr;
+
+    template <Int_t NWords, Int_t NPointsOver>
+    void FindPointsImpl(const Short_t* samples, Int_t nSamples, Double_t baseLine, Double_t baseLineSigma,
+                        Points& points, Workspace& workspace) const;
+
+    void FindChannelPoints(const Short_t* samples, Int_t nSamples, Double_t baseLine,
+                           Double_t baseLineSigma, Points& points, Workspace& workspace) const;
+
+    void ProcessChunk(const TRestRawChannelMatrix& matrix, Int_t chunk, Workspace& workspace);
+    void FillEvent(const TRestRawChannelMatrix& matrix, Int_t first, Int_t last,
+                   TRestDetectorSignalEvent* outputEvent) const;
+
+   public:
+    void BaseLine(const Short_t* samples, Int_t nSamples, Double_t& baseLine, Double_t& baseLineSigma) const;
+
+    Thresholds IntegerThresholds(Double_t baseLine, Double_t baseLineSigma) const;
+
+    void FindPoints(const Short_t* samples, Int_t nSamples, Double_t baseLine, Double_t baseLineSigma,
+                    Points& points, Workspace& workspace) const;
+    void FindPointsReference(const Short_t* samples, Int_t nSamples, Double_t baseLine,
+                             Double_t baseLineSigma, std::vector<Point>& points) const;
+
+    void ProcessChannel(const Short_t* samples, Int_t nSamples, std::vector<Point>& points);
+
+    void ProcessEvent(TRestRawSignalEvent* inputEvent, TRestDetectorSignalEvent* outputEvent);
+
+    void ProcessBatch(const std::vector<TRestRawSignalEvent*>& inputEvents,
+                      const std::vector<TRestDetectorSignalEvent*>& outputEvents);
+
+    void ProcessChannels(const TRestRawChannelMatrix& matrix);
+    void ProcessMatrix(const TRestRawChannelMatrix& matrix, TRestDetectorSignalEvent* outputEvent);
+
+    /// Returns the parameters defining the zero suppression
+    const Parameters& GetParameters() const { return fParameters; }
+
+    void SetNumberOfThreads(Int_t nThreads);
+
+    void SetSpecialization(Bool_t enable);
+
+    /// Returns true if the channels with kFixedSamples samples use a compile-time specialization
+    Bool_t IsSpecialized() const { return fFindPointsFixed != nullptr; }
+
+    /// Returns the number of threads sharing the channels of an event
+    Int_t GetNumberOfThreads() const { return (Int_t)fWorkspaces.size(); }
+
+    explicit TRestRawZeroSuppresionKernel(const Parameters& parameters, Int_t nThreads = 1);
+};
+#endif
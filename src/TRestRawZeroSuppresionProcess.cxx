@@ -54,6 +54,26 @@
 ///
 /// \TODO Add description of observables here.
 ///
+/// ### Replay mode
+///
+/// Archived data processed with this process can be reprocessed using the
+/// persisted parameters when the replay mode of legacy processes is enabled
+/// (see TRestLegacyProcess). In replay mode the process transforms a
+/// TRestRawSignalEvent into a TRestDetectorSignalEvent using the native
+/// kernel implemented at TRestRawZeroSuppresionKernel. The time of the
+/// output points is given by the bin number multiplied by `fSampling`, and
+/// their amplitude is the ADC value with the baseline subtracted. The replay
+/// mode must be enabled also to call Replay or ReplayBatch directly.
+///
+/// \code
+///   TRestLegacyProcess::SetReplayMode(true);
+///   auto zS = (TRestRawZeroSuppresionProcess*)file->Get("zS");
+///   zS->Replay(rawSignalEvent, detectorSignalEvent);
+/// \endcode
+///
+/// Events can also be replayed in batches with ReplayBatch, that amortizes
+/// the setup of each call when the events are small.
+///
 ///
 /// An example of definition of this process inside a data processing chain,
 /// inside the `<TRestProcessRunner>` section.
@@ -93,4 +113,171 @@
 
 #include "TRestRawZeroSuppresionProcess.h"
 
+#include <TBuffer.h>
+
+#include <chrono>
+
+#include "TRestLegacyRegistry.h"
+#include "TRestRawZeroSuppresionKernel.h"
+
 ClassImp(TRestRawZeroSuppresionProcess);
+
+///////////////////////////////////////////////
+/// \brief It counts a new instance of the process, warning only for the first
+/// one created in this program.
+///
+void TRestRawZeroSuppresionProcess::RegisterInstance() {
+    static Counters& counters = GetCounters("TRestRawZeroSuppresionProcess");
+    if (!CountInstance(counters)) return;
+
+    RESTWarning << "Creating legacy process TRestRawZeroSuppresionProcess" << RESTendl;
+    RESTWarning << "This process is now implemented under "
+                << TRestLegacyRegistry::GetModernClass("TRestRawZeroSuppresionProcess")
+                << ". Further instances are only counted" << RESTendl;
+}
+
+///////////////////////////////////////////////
+/// \brief Default destructor
+///
+TRestRawZeroSuppresionProcess::~TRestRawZeroSuppresionProcess() {
+    delete fSignalEvent;
+    delete fKernel;
+}
+
+///////////////////////////////////////////////
+/// \brief It reads or writes the process with the streamer info of its
+/// class, as the streamer generated by ROOT does. Each read is counted in
+/// the metrics of the class, with the bytes taken from the buffer and the
+/// time spent, see TRestLegacyProcess::GetMetrics.
+///
+/// The dictionary must select the class without a streamer,
+/// `#pragma link C++ class TRestRawZeroSuppresionProcess-;`, so that ROOT
+/// uses this one.
+///
+void TRestRawZeroSuppresionProcess::Streamer(TBuffer& buffer) {
+    if (buffer.IsWriting()) {
+        buffer.WriteClassBuffer(TRestRawZeroSuppresionProcess::Class(), this);
+        return;
+    }
+
+    static Counters& counters = GetCounters("TRestRawZeroSuppresionProcess");
+    const Int_t start = buffer.Length();
+    const auto startTime = std::chrono::steady_clock::now();
+    buffer.ReadClassBuffer(TRestRawZeroSuppresionProcess::Class(), this);
+    const auto endTime = std::chrono::steady_clock::now();
+    CountRead(counters, buffer.Length() - start,
+              std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count());
+}
+
+///////////////////////////////////////////////
+/// \brief It creates the output event when the replay mode is enabled.
+///
+void TRestRawZeroSuppresionProcess::Initialize() {
+    if (IsReplayMode() && fSignalEvent == nullptr) fSignalEvent = new TRestDetectorSignalEvent();
+}
+
+any TRestRawZeroSuppresionProcess::GetInputEvent() const {
+    if (!IsReplayMode()) return TRestLegacyProcess::GetInputEvent();
+    return fRawSignalEvent;
+}
+
+any TRestRawZeroSuppresionProcess::GetOutputEvent() const {
+    if (!IsReplayMode()) return TRestLegacyProcess::GetOutputEvent();
+    return fSignalEvent;
+}
+
+///////////////////////////////////////////////
+/// \brief It configures the zero suppression kernel with the persisted parameters.
+///
+void TRestRawZeroSuppresionProcess::InitKernel() {
+    TRestRawZeroSuppresionKernel::Parameters parameters;
+    parameters.fBaseLineStart = (Int_t)fBaseLineRange.X();
+    parameters.fBaseLineEnd = (Int_t)fBaseLineRange.Y();
+    parameters.fIntegralStart = (Int_t)fIntegralRange.X();
+    parameters.fIntegralEnd = (Int_t)fIntegralRange.Y();
+    parameters.fPointThreshold = fPointThreshold;
+    parameters.fSignalThreshold = fSignalThreshold;
+    parameters.fNPointsOverThreshold = fNPointsOverThreshold;
+    parameters.fNPointsFlatThreshold = fNPointsFlatThreshold;
+    parameters.fSampling = fSampling;
+
+    delete fKernel;
+    fKernel = new TRestRawZeroSuppresionKernel(parameters, GetReplayThreads());
+}
+
+///////////////////////////////////////////////
+/// \brief Process initialization. It is only allowed in replay mode.
+///
+void TRestRawZeroSuppresionProcess::InitProcess() {
+    if (!IsReplayMode()) return TRestLegacyProcess::InitProcess();
+
+    Initialize();
+    InitKernel();
+}
+
+///////////////////////////////////////////////
+/// \brief The main processing event function. It is only allowed in replay mode.
+///
+TRestEvent* TRestRawZeroSuppresionProcess::ProcessEvent(TRestEvent* eventInput) {
+    if (!IsReplayMode()) return TRestLegacyProcess::ProcessEvent(eventInput);
+
+    fRawSignalEvent = (TRestRawSignalEvent*)eventInput;
+    Replay(fRawSignalEvent, fSignalEvent);
+
+    if (fSignalEvent->GetNumberOfSignals() <= 0) return nullptr;
+
+    return fSignalEvent;
+}
+
+///////////////////////////////////////////////
+/// \brief It applies the zero suppression defined by the persisted parameters
+/// to `inputEvent`, and it writes the result to `outputEvent`.
+///
+/// It can be called directly on a process read from a file, without adding
+/// the process to a processing chain. As the processing chain, it is only
+/// allowed in replay mode, and `outputEvent` is left untouched otherwise.
+///
+void TRestRawZeroSuppresionProcess::Replay(TRestRawSignalEvent* inputEvent,
+                                           TRestDetectorSignalEvent* outputEvent) {
+    if (!IsReplayMode()) {
+        RESTWarning << "TRestRawZeroSuppresionProcess::Replay. The replay mode of legacy processes is not "
+                       "enabled, see TRestLegacyProcess::SetReplayMode"
+                    << RESTendl;
+        return;
+    }
+
+    if (fKernel == nullptr) InitKernel();
+
+    fKernel->ProcessEvent(inputEvent, outputEvent);
+}
+
+///////////////////////////////////////////////
+/// \brief It applies the zero suppression defined by the persisted parameters
+/// to a batch of events. Each of the `outputEvents` receives the result of
+/// the corresponding event in `inputEvents`.
+///
+/// The result is the same obtained calling Replay for each event, but the
+/// overhead of setting up the buffers and the threads is paid once per
+/// batch. It is intended for runs with many small events. It is only allowed
+/// in replay mode.
+///
+void TRestRawZeroSuppresionProcess::ReplayBatch(const std::vector<TRestRawSignalEvent*>& inputEvents,
+                                                const std::vector<TRestDetectorSignalEvent*>& outputEvents) {
+    if (!IsReplayMode()) {
+        RESTWarning << "TRestRawZeroSuppresionProcess::ReplayBatch. The replay mode of legacy processes is "
+                       "not enabled, see TRestLegacyProcess::SetReplayMode"
+                    << RESTendl;
+        return;
+    }
+
+    if (inputEvents.size() != outputEvents.size()) {
+        RESTError << "TRestRawZeroSuppresionProcess::ReplayBatch. The number of input events ("
+                  << inputEvents.size() << ") and output events (" << outputEvents.size()
+                  << ") does not match" << RESTendl;
+        return;
+    }
+
+    if (fKernel == nullptr) InitKernel();
+
+    fKernel->ProcessBatch(inputEvents, outputEvents);
+}
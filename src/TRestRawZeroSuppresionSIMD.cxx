@@ -0,0 +1,488 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestRawZeroSuppresionSIMD collects the vectorized building blocks used
+/// by TRestRawZeroSuppresionKernel. Each of them has a scalar reference
+/// implementation, and AVX2 and AVX-512 implementations that are compiled
+/// for x86-64 with GCC or Clang. The instruction set is selected at runtime
+/// from the capabilities of the CPU, and it can be lowered with
+/// SetInstructionSet, i.e. to compare the results with the scalar reference.
+///
+/// The baseline is calculated over a window of samples of several channels
+/// stored with a fixed stride. The vectorized versions process four
+/// channels in each pass, and they accumulate the sum and the sum of
+/// squares of the samples exactly in integer arithmetic. Therefore, they
+/// give exactly the same result as the scalar reference.
+///
+/// The samples over threshold are identified with vector compares, that
+/// produce a mask of 64 bits for each block of 64 samples. The threshold
+/// is an integer, so that the samples are compared directly as 16-bit
+/// integers, without any conversion.
+///
+/// The flat parts of a signal are identified in the same way, with a mask
+/// where each bit tells if the difference between a sample and the
+/// previous one is within a limit. The absolute differences are evaluated
+/// exactly as unsigned 16-bit integers, with saturating subtractions.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestRawZeroSuppresionSIMD
+///
+/// <hr>
+///
+
+#include "TRestRawZeroSuppresionSIMD.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define REST_ZERO_SUPPRESION_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/// The sums of the samples are accumulated in 32-bit lanes, which limits the window length
+constexpr Int_t kMaxVectorWindow = 1 << 16;
+
+std::atomic<int> gInstructionSet{-1};
+
+/// It transforms the exact sums of a window into its mean and standard deviation
+inline void Moments(Long64_t sum, Long64_t sumSquares, Long64_t n, Double_t& mean, Double_t& sigma) {
+    mean = (Double_t)sum / n;
+    sigma = std::sqrt((Double_t)(n * sumSquares - sum * sum)) / n;
+}
+
+void BaseLineScalarChannel(const Short_t* samples, Int_t from, Int_t to, Long64_t& sum,
+                           Long64_t& sumSquares) {
+    sum = 0;
+    sumSquares = 0;
+    for (Int_t i = from; i < to; i++) {
+        sum += samples[i];
+        sumSquares += (Long64_t)samples[i] * samples[i];
+    }
+}
+
+#ifdef REST_ZERO_SUPPRESION_X86
+
+__attribute__((target("avx2"))) inline Long64_t HorizontalSum32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+__attribute__((target("avx2"))) inline Long64_t HorizontalSum64(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+    return _mm_cvtsi128_si64(s);
+}
+
+/// It accumulates 16 samples. The products of the 16-bit pairs summed by madd never exceed 2^31,
+/// so that they are exact when they are interpreted as unsigned 32-bit values.
+__attribute__((target("avx2"))) inline void Accumulate16(const Short_t* samples, __m256i ones, __m256i& sum,
+                                                         __m256i& sumSquares) {
+    const __m256i x = _mm256_loadu_si256((const __m256i*)samples);
+    const __m256i squares = _mm256_madd_epi16(x, x);
+    sum = _mm256_add_epi32(sum, _mm256_madd_epi16(x, ones));
+    sumSquares = _mm256_add_epi64(sumSquares, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(squares)));
+    sumSquares = _mm256_add_epi64(sumSquares, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(squares, 1)));
+}
+
+__attribute__((target("avx2"))) void BaseLineAVX2(const Short_t* data, size_t stride, size_t nChannels,
+                                                  Int_t from, Int_t to, Long64_t* sums,
+                                                  Long64_t* sumsSquares) {
+    constexpr size_t kChannels = 4;
+    const __m256i ones = _mm256_set1_epi16(1);
+    const Int_t vectorEnd = from + (to - from) / 16 * 16;
+
+    size_t c = 0;
+    for (; c + kChannels <= nChannels; c += kChannels) {
+        __m256i sum[kChannels];
+        __m256i sumSquares[kChannels];
+        for (size_t k = 0; k < kChannels; k++) sum[k] = sumSquares[k] = _mm256_setzero_si256();
+
+        for (Int_t i = from; i < vectorEnd; i += 16)
+            for (size_t k = 0; k < kChannels; k++)
+                Accumulate16(data + (c + k) * stride + i, ones, sum[k], sumSquares[k]);
+
+        for (size_t k = 0; k < kChannels; k++) {
+            Long64_t tailSum, tailSumSquares;
+            BaseLineScalarChannel(data + (c + k) * stride, vectorEnd, to, tailSum, tailSumSquares);
+            sums[c + k] = HorizontalSum32(sum[k]) + tailSum;
+            sumsSquares[c + k] = HorizontalSum64(sumSquares[k]) + tailSumSquares;
+        }
+    }
+
+    for (; c < nChannels; c++) {
+        __m256i sum = _mm256_setzero_si256();
+        __m256i sumSquares = _mm256_setzero_si256();
+        for (Int_t i = from; i < vectorEnd; i += 16)
+            Accumulate16(data + c * stride + i, ones, sum, sumSquares);
+
+        Long64_t tailSum, tailSumSquares;
+        BaseLineScalarChannel(data + c * stride, vectorEnd, to, tailSum, tailSumSquares);
+        sums[c] = HorizontalSum32(sum) + tailSum;
+        sumsSquares[c] = HorizontalSum64(sumSquares) + tailSumSquares;
+    }
+}
+
+/// It accumulates up to 32 samples, the ones outside `mask` are loaded as zero. The squares are
+/// widened in place, splitting each 64-bit lane into its low and high 32-bit halves.
+__attribute__((target("avx512f,avx512bw"))) inline void Accumulate32(const Short_t* samples, __mmask32 mask,
+                                                                     __m512i ones, __m512i& sum,
+                                                                     __m512i& sumSquares) {
+    const __m512i low = _mm512_set1_epi64(0xFFFFFFFF);
+    const __m512i x = _mm512_maskz_loadu_epi16(mask, samples);
+    const __m512i squares = _mm512_madd_epi16(x, x);
+    sum = _mm512_add_epi32(sum, _mm512_madd_epi16(x, ones));
+    sumSquares = _mm512_add_epi64(sumSquares, _mm512_and_si512(squares, low));
+    sumSquares = _mm512_add_epi64(sumSquares, _mm512_maskz_srli_epi64(0xFF, squares, 32));
+}
+
+/// The halves of a vector are extracted with a zero mask, since the unmasked extractions, as the
+/// ones inside _mm512_reduce_add_epi32, merge into an undefined vector
+__attribute__((target("avx512f,avx512bw"))) inline __m256i AddHalves32(__m512i v) {
+    return _mm256_add_epi32(_mm512_maskz_extracti64x4_epi64(0xF, v, 0),
+                            _mm512_maskz_extracti64x4_epi64(0xF, v, 1));
+}
+
+__attribute__((target("avx512f,avx512bw"))) inline __m256i AddHalves64(__m512i v) {
+    return _mm256_add_epi64(_mm512_maskz_extracti64x4_epi64(0xF, v, 0),
+                            _mm512_maskz_extracti64x4_epi64(0xF, v, 1));
+}
+
+__attribute__((target("avx512f,avx512bw"))) void BaseLineAVX512(const Short_t* data, size_t stride,
+                                                                size_t nChannels, Int_t from, Int_t to,
+                                                                Long64_t* sums, Long64_t* sumsSquares) {
+    constexpr size_t kChannels = 4;
+    const __m512i ones = _mm512_set1_epi16(1);
+    const Int_t vectorEnd = from + (to - from) / 32 * 32;
+    const __mmask32 tailMask = (1u << (to - vectorEnd)) - 1;
+
+    size_t c = 0;
+    for (; c + kChannels <= nChannels; c += kChannels) {
+        __m512i sum[kChannels];
+        __m512i sumSquares[kChannels];
+        for (size_t k = 0; k < kChannels; k++) sum[k] = sumSquares[k] = _mm512_setzero_si512();
+
+        for (Int_t i = from; i < vectorEnd; i += 32)
+            for (size_t k = 0; k < kChannels; k++)
+                Accumulate32(data + (c + k) * stride + i, 0xFFFFFFFFu, ones, sum[k], sumSquares[k]);
+
+        for (size_t k = 0; k < kChannels; k++) {
+            Accumulate32(data + (c + k) * stride + vectorEnd, tailMask, ones, sum[k], sumSquares[k]);
+            sums[c + k] = HorizontalSum32(AddHalves32(sum[k]));
+            sumsSquares[c + k] = HorizontalSum64(AddHalves64(sumSquares[k]));
+        }
+    }
+
+    for (; c < nChannels; c++) {
+        __m512i sum = _mm512_setzero_si512();
+        __m512i sumSquares = _mm512_setzero_si512();
+        for (Int_t i = from; i < vectorEnd; i += 32)
+            Accumulate32(data + c * stride + i, 0xFFFFFFFFu, ones, sum, sumSquares);
+        Accumulate32(data + c * stride + vectorEnd, tailMask, ones, sum, sumSquares);
+        sums[c] = HorizontalSum32(AddHalves32(sum));
+        sumsSquares[c] = HorizontalSum64(AddHalves64(sumSquares));
+    }
+}
+
+/// It gathers the sign bits of the 16-bit lanes of `low` and `high` into a mask of 32 bits. The
+/// saturating pack keeps the sign of each lane, and the permutation restores the lane order.
+__attribute__((target("avx2"))) inline ULong64_t MoveMask16AVX2(__m256i low, __m256i high) {
+    const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+    return (UInt_t)_mm256_movemask_epi8(packed);
+}
+
+/// It sets the bits of the samples of a block of 64 that are over `threshold`
+__attribute__((target("avx2"))) inline ULong64_t OverThresholdBlockAVX2(const Short_t* samples,
+                                                                        __m256i threshold) {
+    ULong64_t bits = 0;
+    for (int k = 0; k < 64; k += 32) {
+        const __m256i low = _mm256_loadu_si256((const __m256i*)(samples + k));
+        const __m256i high = _mm256_loadu_si256((const __m256i*)(samples + k + 16));
+        bits |= MoveMask16AVX2(_mm256_cmpgt_epi16(low, threshold), _mm256_cmpgt_epi16(high, threshold)) << k;
+    }
+    return bits;
+}
+
+__attribute__((target("avx2"))) void OverThresholdMaskAVX2(const Short_t* samples, Int_t nBlocks,
+                                                           Short_t threshold, ULong64_t* mask) {
+    const __m256i thresholdVector = _mm256_set1_epi16(threshold);
+    for (Int_t w = 0; w < nBlocks; w++) mask[w] = OverThresholdBlockAVX2(samples + 64 * w, thresholdVector);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void OverThresholdMaskAVX512(const Short_t* samples,
+                                                                         Int_t nBlocks, Short_t threshold,
+                                                                         ULong64_t* mask) {
+    const __m512i thresholdVector = _mm512_set1_epi16(threshold);
+    for (Int_t w = 0; w < nBlocks; w++) {
+        const __m512i low = _mm512_loadu_si512((const void*)(samples + 64 * w));
+        const __m512i high = _mm512_loadu_si512((const void*)(samples + 64 * w + 32));
+        // The halves are joined in the mask registers. Joining them as integers is miscompiled by
+        // GCC 12 with -O1 -fsanitize=undefined, that spills the low half as 32 bits.
+        mask[w] = _mm512_kunpackd(_mm512_cmpgt_epi16_mask(high, thresholdVector),
+                                  _mm512_cmpgt_epi16_mask(low, thresholdVector));
+    }
+}
+
+/// It returns the absolute difference of each sample with the previous one, as unsigned 16-bit
+/// lanes. The samples are biased to unsigned values, and the difference is the sum of the two
+/// saturating subtractions, one of which is always zero.
+__attribute__((target("avx2"))) inline __m256i StepAVX2(const Short_t* samples) {
+    const __m256i bias = _mm256_set1_epi16((Short_t)0x8000);
+    const __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)samples), bias);
+    const __m256i previous = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(samples - 1)), bias);
+    return _mm256_or_si256(_mm256_subs_epu16(x, previous), _mm256_subs_epu16(previous, x));
+}
+
+/// It sets the bits of the samples of a block of 64 that differ from the previous one at most `limit`
+__attribute__((target("avx2"))) inline ULong64_t FlatBlockAVX2(const Short_t* samples, __m256i limit) {
+    ULong64_t bits = 0;
+    for (int k = 0; k < 64; k += 32) {
+        // A step is within the limit if subtracting the limit saturates to zero
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i low = _mm256_cmpeq_epi16(_mm256_subs_epu16(StepAVX2(samples + k), limit), zero);
+        const __m256i high = _mm256_cmpeq_epi16(_mm256_subs_epu16(StepAVX2(samples + k + 16), limit), zero);
+        bits |= MoveMask16AVX2(low, high) << k;
+    }
+    return bits;
+}
+
+__attribute__((target("avx2"))) void FlatMaskAVX2(const Short_t* samples, Int_t firstBlock, Int_t nBlocks,
+                                                  UShort_t limit, ULong64_t* mask) {
+    const __m256i limitVector = _mm256_set1_epi16((Short_t)limit);
+    for (Int_t w = firstBlock; w < nBlocks; w++) mask[w] = FlatBlockAVX2(samples + 64 * w, limitVector);
+}
+
+__attribute__((target("avx512f,avx512bw"))) void FlatMaskAVX512(const Short_t* samples, Int_t firstBlock,
+                                                                Int_t nBlocks, UShort_t limit,
+                                                                ULong64_t* mask) {
+    const __m512i bias = _mm512_set1_epi16((Short_t)0x8000);
+    const __m512i limitVector = _mm512_set1_epi16((Short_t)limit);
+    for (Int_t w = firstBlock; w < nBlocks; w++) {
+        ULong64_t bits = 0;
+        for (int k = 0; k < 64; k += 32) {
+            const Short_t* block = samples + 64 * w + k;
+            const __m512i x = _mm512_xor_si512(_mm512_loadu_si512((const void*)block), bias);
+            const __m512i previous = _mm512_xor_si512(_mm512_loadu_si512((const void*)(block - 1)), bias);
+            const __m512i step =
+                _mm512_or_si512(_mm512_subs_epu16(x, previous), _mm512_subs_epu16(previous, x));
+            bits |= (ULong64_t)_mm512_cmple_epu16_mask(step, limitVector) << k;
+        }
+        mask[w] = bits;
+    }
+}
+
+#endif
+
+}  // namespace
+
+///////////////////////////////////////////////
+/// \brief Returns the best instruction set supported by the CPU running the code
+///
+TRestRawZeroSuppresionSIMD::InstructionSet TRestRawZeroSuppresionSIMD::GetSupportedInstructionSet() {
+#ifdef REST_ZERO_SUPPRESION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+        return InstructionSet::kAVX512;
+    if (__builtin_cpu_supports("avx2")) return InstructionSet::kAVX2;
+#endif
+    return InstructionSet::kScalar;
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the instruction set used by the kernels. By default, the
+/// best one supported by the CPU.
+///
+TRestRawZeroSuppresionSIMD::InstructionSet TRestRawZeroSuppresionSIMD::GetInstructionSet() {
+    int instructionSet = gInstructionSet.load(std::memory_order_relaxed);
+    if (instructionSet < 0) {
+        instructionSet = (int)GetSupportedInstructionSet();
+        gInstructionSet.store(instructionSet, std::memory_order_relaxed);
+    }
+    return (InstructionSet)instructionSet;
+}
+
+///////////////////////////////////////////////
+/// \brief It sets the instruction set used by the kernels. It is limited to the
+/// ones supported by the CPU.
+///
+void TRestRawZeroSuppresionSIMD::SetInstructionSet(InstructionSet instructionSet) {
+    const int supported = (int)GetSupportedInstructionSet();
+    gInstructionSet.store(std::min((int)instructionSet, supported), std::memory_order_relaxed);
+}
+
+///////////////////////////////////////////////
+/// \brief Returns the name of the given instruction set
+///
+std::string TRestRawZeroSuppresionSIMD::GetInstructionSetName(InstructionSet instructionSet) {
+    switch (instructionSet) {
+        case InstructionSet::kAVX512:
+            return "AVX-512";
+        case InstructionSet::kAVX2:
+            return "AVX2";
+        default:
+            return "scalar";
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It calculates the baseline, and the baseline fluctuation, of
+/// `nChannels` channels, as the mean and the standard deviation of the
+/// samples in the bin range [from, to).
+///
+/// The samples of channel `c` start at `data + c * stride`. Both results are
+/// set to zero if the range is empty.
+///
+void TRestRawZeroSuppresionSIMD::BaseLine(const Short_t* data, size_t stride, size_t nChannels, Int_t from,
+                                          Int_t to, Double_t* baseLine, Double_t* baseLineSigma) {
+#ifdef REST_ZERO_SUPPRESION_X86
+    const InstructionSet instructionSet = GetInstructionSet();
+    if (instructionSet != InstructionSet::kScalar && to > from && to - from <= kMaxVectorWindow) {
+        constexpr size_t kBlock = 64;
+        Long64_t sums[kBlock];
+        Long64_t sumsSquares[kBlock];
+        for (size_t c = 0; c < nChannels; c += kBlock) {
+            const size_t n = std::min(kBlock, nChannels - c);
+            if (instructionSet == InstructionSet::kAVX512)
+                BaseLineAVX512(data + c * stride, stride, n, from, to, sums, sumsSquares);
+            else
+                BaseLineAVX2(data + c * stride, stride, n, from, to, sums, sumsSquares);
+
+            for (size_t k = 0; k < n; k++)
+                Moments(sums[k], sumsSquares[k], to - from, baseLine[c + k], baseLineSigma[c + k]);
+        }
+        return;
+    }
+#endif
+    BaseLineScalar(data, stride, nChannels, from, to, baseLine, baseLineSigma);
+}
+
+///////////////////////////////////////////////
+/// \brief The scalar reference of BaseLine
+///
+void TRestRawZeroSuppresionSIMD::BaseLineScalar(const Short_t* data, size_t stride, size_t nChannels,
+                                                Int_t from, Int_t to, Double_t* baseLine,
+                                                Double_t* baseLineSigma) {
+    for (size_t c = 0; c < nChannels; c++) {
+        if (to <= from) {
+            baseLine[c] = 0;
+            baseLineSigma[c] = 0;
+            continue;
+        }
+
+        Long64_t sum, sumSquares;
+        BaseLineScalarChannel(data + c * stride, from, to, sum, sumSquares);
+        Moments(sum, sumSquares, to - from, baseLine[c], baseLineSigma[c]);
+    }
+}
+
+///////////////////////////////////////////////
+/// \brief It sets in `mask` the bits of the samples that are larger than
+/// `threshold`.
+///
+/// Bit `i % 64` of `mask[i / 64]` corresponds to sample `i`. The mask must
+/// have room for `(nSamples + 63) / 64` words, and the bits beyond
+/// `nSamples` are cleared.
+///
+void TRestRawZeroSuppresionSIMD::OverThresholdMask(const Short_t* samples, Int_t nSamples, Int_t threshold,
+                                                   ULong64_t* mask) {
+#ifdef REST_ZERO_SUPPRESION_X86
+    // A threshold outside the range of the samples selects all of them or none
+    const InstructionSet instructionSet = GetInstructionSet();
+    if (instructionSet != InstructionSet::kScalar && threshold >= -32768 && threshold < 32767) {
+        const Int_t nBlocks = nSamples / 64;
+        if (instructionSet == InstructionSet::kAVX512)
+            OverThresholdMaskAVX512(samples, nBlocks, (Short_t)threshold, mask);
+        else
+            OverThresholdMaskAVX2(samples, nBlocks, (Short_t)threshold, mask);
+
+        if (nSamples % 64 != 0)
+            OverThresholdMaskScalar(samples + 64 * nBlocks, nSamples % 64, threshold, mask + nBlocks);
+        return;
+    }
+#endif
+    OverThresholdMaskScalar(samples, nSamples, threshold, mask);
+}
+
+///////////////////////////////////////////////
+/// \brief The scalar reference of OverThresholdMask
+///
+void TRestRawZeroSuppresionSIMD::OverThresholdMaskScalar(const Short_t* samples, Int_t nSamples,
+                                                         Int_t threshold, ULong64_t* mask) {
+    for (Int_t w = 0; w < (nSamples + 63) / 64; w++) mask[w] = 0;
+    for (Int_t i = 0; i < nSamples; i++)
+        if (samples[i] > threshold) mask[i / 64] |= 1ULL << (i % 64);
+}
+
+///////////////////////////////////////////////
+/// \brief It sets in `mask` the bits of the samples whose absolute difference
+/// with the previous sample is not larger than `limit`.
+///
+/// The layout of the mask is the same as in OverThresholdMask. The bit of
+/// the first sample is always cleared, since it has no previous sample.
+///
+void TRestRawZeroSuppresionSIMD::FlatMask(const Short_t* samples, Int_t nSamples, Int_t limit,
+                                          ULong64_t* mask) {
+#ifdef REST_ZERO_SUPPRESION_X86
+    const InstructionSet instructionSet = GetInstructionSet();
+    if (instructionSet != InstructionSet::kScalar && nSamples >= 64 && limit >= 0) {
+        // The first block is evaluated by the scalar version, it has no previous sample. No
+        // difference between two samples is larger than 65535.
+        const Int_t nBlocks = nSamples / 64;
+        const UShort_t vectorLimit = (UShort_t)std::min(limit, 65535);
+        FlatMaskScalar(samples, 64, limit, mask);
+        if (instructionSet == InstructionSet::kAVX512)
+            FlatMaskAVX512(samples, 1, nBlocks, vectorLimit, mask);
+        else
+            FlatMaskAVX2(samples, 1, nBlocks, vectorLimit, mask);
+
+        if (nSamples % 64 != 0) {
+            // The tail is evaluated starting at the last sample of the previous block, whose bit
+            // is then shifted out
+            ULong64_t tail;
+            FlatMaskScalar(samples + 64 * nBlocks - 1, nSamples % 64 + 1, limit, &tail);
+            mask[nBlocks] = tail >> 1;
+        }
+        return;
+    }
+#endif
+    FlatMaskScalar(samples, nSamples, limit, mask);
+}
+
+///////////////////////////////////////////////
+/// \brief The scalar reference of FlatMask
+///
+void TRestRawZeroSuppresionSIMD::FlatMaskScalar(const Short_t* samples, Int_t nSamples, Int_t limit,
+                                                ULong64_t* mask) {
+    for (Int_t w = 0; w < (nSamples + 63) / 64; w++) mask[w] = 0;
+    for (Int_t i = 1; i < nSamples; i++)
+        if (std::abs(samples[i] - samples[i - 1]) <= limit) mask[i / 64] |= 1ULL << (i % 64);
+}
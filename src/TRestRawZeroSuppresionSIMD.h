@@ -0,0 +1,54 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestRawZeroSuppresionSIMD
+#define RestCore_TRestRawZeroSuppresionSIMD
+
+#include <Rtypes.h>
+
+#include <cstddef>
+#include <string>
+
+//! Vectorized building blocks of the legacy zero suppression, selected at runtime
+class TRestRawZeroSuppresionSIMD {
+   public:
+    /// The instruction sets with a dedicated implementation
+    enum class InstructionSet { kScalar = 0, kAVX2 = 1, kAVX512 = 2 };
+
+    static InstructionSet GetInstructionSet();
+    static InstructionSet GetSupportedInstructionSet();
+    static void SetInstructionSet(InstructionSet instructionSet);
+    static std::string GetInstructionSetName(InstructionSet instructionSet);
+
+    static void BaseLine(const Short_t* data, size_t stride, size_t nChannels, Int_t from, Int_t to,
+                         Double_t* baseLine, Double_t* baseLineSigma);
+    static void BaseLineScalar(const Short_t* data, size_t stride, size_t nChannels, Int_t from, Int_t to,
+                               Double_t* baseLine, Double_t* baseLineSigma);
+
+    static void OverThresholdMask(const Short_t* samples, Int_t nSamples, Int_t threshold, ULong64_t* mask);
+    static void OverThresholdMaskScalar(const Short_t* samples, Int_t nSamples, Int_t threshold,
+                                        ULong64_t* mask);
+
+    static void FlatMask(const Short_t* samples, Int_t nSamples, Int_t limit, ULong64_t* mask);
+    static void FlatMaskScalar(const Short_t* samples, Int_t nSamples, Int_t limit, ULong64_t* mask);
+};
+#endif
@@ -0,0 +1,262 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// TRestRawZeroSuppresionStream applies the zero suppression of the legacy
+/// TRestRawZeroSuppresionProcess to the samples of a channel as they are
+/// digitized, without waiting for the complete signal. It gives exactly the
+/// same points as TRestRawZeroSuppresionKernel.
+///
+/// The samples of a channel are given between BeginChannel and EndChannel,
+/// in as many calls to Push as needed. The sums defining the baseline are
+/// accumulated while the samples of the baseline range arrive, and the
+/// samples of the integral range arriving before the end of the baseline
+/// range are kept until the baseline is known. From then on, each sample
+/// is compared with the integer thresholds of the channel as it arrives,
+/// and only the samples of the pulse being identified are kept.
+///
+/// A pulse is decided as soon as it ends, either at the first sample that
+/// is not over threshold, at the sample completing a flat tail, or at the
+/// end of the integral range. The points of an accepted pulse are then
+/// emitted to a lock-free ring buffer, where they are taken with Pop. The
+/// stream never waits for room in the ring buffer. When it is full, Push
+/// stops after the sample that ended the pulse, and it returns the number
+/// of samples consumed. The remaining points are kept by the stream, and
+/// they are emitted by the next call to Push, EndChannel or Flush, once the
+/// consumer has made room for them.
+///
+/// The consumer can run in another thread, or in the same thread as the
+/// producer, taking the points whenever Push does not consume all the
+/// samples given.
+///
+/// \code
+///     TRestRawZeroSuppresionStream stream(parameters);
+///     TRestRawZeroSuppresionStream::Point point;
+///
+///     stream.BeginChannel(signalID);
+///     for (Int_t n = 0; n < nSamples; n += stream.Push(samples + n, nSamples - n))
+///         while (stream.Pop(point)) { ... }
+///
+///     for (Bool_t flushed = stream.EndChannel();; flushed = stream.Flush()) {
+///         while (stream.Pop(point)) { ... }
+///         if (flushed) break;
+///     }
+/// \endcode
+///
+/// A stream is fed by a single producer thread. Several channels may be
+/// processed concurrently using one stream for each of them.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// \class      TRestRawZeroSuppresionStream
+///
+/// <hr>
+///
+
+#include "TRestRawZeroSuppresionStream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+TRestRawZeroSuppresionStream::TRestRawZeroSuppresionStream(
+    const TRestRawZeroSuppresionKernel::Parameters& parameters, size_t capacity)
+    : fKernel(parameters), fOutput(capacity) {}
+
+///////////////////////////////////////////////
+/// \brief It starts a new channel, whose samples are given by the following
+/// calls to Push. The previous channel must have been ended by EndChannel.
+/// Its points that did not fit in the output are still emitted first.
+///
+void TRestRawZeroSuppresionStream::BeginChannel(Int_t signalID) {
+    fSignalID = signalID;
+    fBin = 0;
+    fBaseLineSum = 0;
+    fBaseLineSumSquares = 0;
+    fBaseLineReady = false;
+    fPending.clear();
+    fPulse.clear();
+
+    // An empty baseline range is known from the beginning
+    const TRestRawZeroSuppresionKernel::Parameters& parameters = GetParameters();
+    if (parameters.fBaseLineEnd <= std::max(parameters.fBaseLineStart, 0)) SetBaseLine();
+}
+
+///////////////////////////////////////////////
+/// \brief It processes the next `nSamples` samples of the current channel.
+/// The points of the pulses that end in these samples are emitted.
+///
+/// It returns the number of samples consumed. It is less than `nSamples`
+/// if the output is full, and the samples that were not consumed must be
+/// given again once the consumer has taken some points.
+///
+Int_t TRestRawZeroSuppresionStream::Push(const Short_t* samples, Int_t nSamples) {
+    if (!Flush()) return 0;
+
+    const TRestRawZeroSuppresionKernel::Parameters& parameters = GetParameters();
+    const Int_t baseLineStart = std::max(parameters.fBaseLineStart, 0);
+    const Int_t integralStart = std::max(parameters.fIntegralStart, 0);
+    const Int_t integralEnd = parameters.fIntegralEnd;
+
+    for (Int_t n = 0; n < nSamples; n++) {
+        const Int_t bin = fBin++;
+        const Short_t sample = samples[n];
+        const Bool_t inIntegral = bin >= integralStart && (integralEnd <= 0 || bin < integralEnd);
+
+        if (fBaseLineReady) {
+            if (inIntegral) ProcessSample(bin, sample);
+        } else {
+            if (bin >= baseLineStart && bin < parameters.fBaseLineEnd) {
+                fBaseLineSum += sample;
+                fBaseLineSumSquares += (Long64_t)sample * sample;
+            }
+            if (inIntegral) {
+                if (fPending.empty()) fPendingStart = bin;
+                fPending.push_back(sample);
+            }
+            if (bin + 1 >= parameters.fBaseLineEnd) SetBaseLine();
+        }
+
+        if (!fUnsent.empty()) return n + 1;
+    }
+    return nSamples;
+}
+
+///////////////////////////////////////////////
+/// \brief It ends the current channel, deciding the last pulse. If the
+/// channel is shorter than the baseline range, the baseline is calculated
+/// with the samples received.
+///
+/// It returns false if some points did not fit in the output, see Flush.
+///
+Bool_t TRestRawZeroSuppresionStream::EndChannel() {
+    if (!fBaseLineReady) SetBaseLine();
+    if (!fPulse.empty()) EndPulse();
+    return Flush();
+}
+
+///////////////////////////////////////////////
+/// \brief It emits the points that did not fit in the output before. It
+/// returns true if all of them have been emitted.
+///
+Bool_t TRestRawZeroSuppresionStream::Flush() {
+    for (; fSent < fUnsent.size(); fSent++)
+        if (!fOutput.TryPush(fUnsent[fSent])) return false;
+
+    fUnsent.clear();
+    fSent = 0;
+    return true;
+}
+
+///////////////////////////////////////////////
+/// \brief It calculates the baseline and the thresholds of the current
+/// channel, and it processes the samples that were waiting for them.
+///
+/// The baseline is calculated from the exact sums of the samples, as in
+/// TRestRawZeroSuppresionSIMD, so that it is exactly the same.
+///
+void TRestRawZeroSuppresionStream::SetBaseLine() {
+    const TRestRawZeroSuppresionKernel::Parameters& parameters = GetParameters();
+    const Long64_t n = std::min(parameters.fBaseLineEnd, fBin) - std::max(parameters.fBaseLineStart, 0);
+
+    fBaseLine = 0;
+    fBaseLineSigma = 0;
+    if (n > 0) {
+        fBaseLine = (Double_t)fBaseLineSum / n;
+        fBaseLineSigma = std::sqrt((Double_t)(n * fBaseLineSumSquares - fBaseLineSum * fBaseLineSum)) / n;
+    }
+    fThresholds = fKernel.IntegerThresholds(fBaseLine, fBaseLineSigma);
+    fSignalThreshold = parameters.fSignalThreshold * fBaseLineSigma;
+    fBaseLineReady = true;
+
+    for (size_t p = 0; p < fPending.size(); p++) ProcessSample(fPendingStart + (Int_t)p, fPending[p]);
+    fPending.clear();
+}
+
+///////////////////////////////////////////////
+/// \brief It processes one sample of the integral range, once the baseline
+/// is known.
+///
+/// A sample over threshold starts a pulse, that is extended with the next
+/// samples while they are over threshold. The sample ending a pulse is not
+/// considered to start the next one, as in the legacy process.
+///
+void TRestRawZeroSuppresionStream::ProcessSample(Int_t bin, Short_t sample) {
+    const TRestRawZeroSuppresionKernel::Parameters& parameters = GetParameters();
+    const Bool_t over = sample > fThresholds.fPoint;
+
+    if (fPulse.empty()) {
+        if (over) {
+            fPulseStart = bin;
+            fPulse.push_back(sample);
+            fFlatSteps = 0;
+        }
+    } else if (!over) {
+        EndPulse();
+        return;
+    } else {
+        if (std::abs(sample - fPulse.back()) > fThresholds.fFlat)
+            fFlatSteps = 0;
+        else
+            fFlatSteps++;
+
+        if (fFlatSteps >= parameters.fNPointsFlatThreshold) {
+            EndPulse();
+            return;
+        }
+        fPulse.push_back(sample);
+    }
+
+    // The last sample of the integral range ends the pulse without waiting for the next one
+    if (bin + 1 == parameters.fIntegralEnd && !fPulse.empty()) EndPulse();
+}
+
+///////////////////////////////////////////////
+/// \brief It decides the current pulse, and it emits its points if it is
+/// accepted.
+///
+void TRestRawZeroSuppresionStream::EndPulse() {
+    const TRestRawZeroSuppresionKernel::Parameters& parameters = GetParameters();
+    const Long64_t n = fPulse.size();
+
+    if (n >= parameters.fNPointsOverThreshold) {
+        Long64_t sum = 0;
+        Long64_t sumSquares = 0;
+        for (const Short_t sample : fPulse) {
+            sum += sample;
+            sumSquares += (Long64_t)sample * sample;
+        }
+
+        // Population deviation, as the kernel computes it
+        if (std::sqrt((Double_t)(n * sumSquares - sum * sum)) / n > fSignalThreshold) {
+            // The points are emitted after the ones still waiting, to keep their order
+            for (Long64_t j = 0; j < n; j++) {
+                const Point point = {fSignalID, (fPulseStart + (Int_t)j) * parameters.fSampling,
+                                     fPulse[j] - fBaseLine};
+                if (!fUnsent.empty() || !fOutput.TryPush(point)) fUnsent.push_back(point);
+            }
+        }
+    }
+    fPulse.clear();
+}
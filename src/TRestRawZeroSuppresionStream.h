@@ -0,0 +1,112 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+#ifndef RestCore_TRestRawZeroSuppresionStream
+#define RestCore_TRestRawZeroSuppresionStream
+
+#include <Rtypes.h>
+
+#include <vector>
+
+#include "TRestLegacyRingBuffer.h"
+#include "TRestRawZeroSuppresionKernel.h"
+
+//! The zero suppression of the legacy TRestRawZeroSuppresionProcess, applied to samples as they arrive
+class TRestRawZeroSuppresionStream {
+   public:
+    /// A sample that survived the zero suppression, as it is emitted by the stream
+    struct Point {
+        Int_t fSignalID;
+        Double_t fTime;
+        Double_t fData;
+    };
+
+    typedef TRestLegacyRingBuffer<Point> Output;
+
+   private:
+    /// The kernel defining the parameters and the thresholds of the zero suppression
+    TRestRawZeroSuppresionKernel fKernel;
+
+    /// The points emitted, waiting to be taken by the consumer
+    Output fOutput;
+
+    /// The signal id of the current channel
+    Int_t fSignalID = 0;
+
+    /// The bin of the next sample of the current channel
+    Int_t fBin = 0;
+
+    /// The exact sums of the samples in the baseline range received so far
+    Long64_t fBaseLineSum = 0;
+    Long64_t fBaseLineSumSquares = 0;
+
+    /// True once the baseline of the current channel is known
+    Bool_t fBaseLineReady = false;
+
+    Double_t fBaseLine = 0;
+    Double_t fBaseLineSigma = 0;
+    TRestRawZeroSuppresionKernel::Thresholds fThresholds;
+    Double_t fSignalThreshold = 0;
+
+    /// The samples of the integral range received before the baseline was known
+    std::vector<Short_t> fPending;
+
+    /// The bin of the first pending sample
+    Int_t fPendingStart = 0;
+
+    /// The samples of the pulse being identified, starting at fPulseStart
+    std::vector<Short_t> fPulse;
+    Int_t fPulseStart = 0;
+
+    /// The number of consecutive flat steps at the end of the pulse
+    Int_t fFlatSteps = 0;
+
+    /// The points of the accepted pulses that did not fit in the output yet
+    std::vector<Point> fUnsent;
+
+    /// The number of points of fUnsent already moved to the output
+    size_t fSent = 0;
+
+    void SetBaseLine();
+    void ProcessSample(Int_t bin, Short_t sample);
+    void EndPulse();
+
+   public:
+    void BeginChannel(Int_t signalID);
+    Int_t Push(const Short_t* samples, Int_t nSamples);
+    Bool_t EndChannel();
+    Bool_t Flush();
+
+    /// It takes the next point emitted. It returns false if there is none. Only one consumer thread
+    /// may take points at the same time.
+    Bool_t Pop(Point& point) { return fOutput.TryPop(point); }
+
+    /// Returns the queue with the points emitted, that are taken by the consumer
+    Output& GetOutput() { return fOutput; }
+
+    /// Returns the parameters defining the zero suppression
+    const TRestRawZeroSuppresionKernel::Parameters& GetParameters() const { return fKernel.GetParameters(); }
+
+    explicit TRestRawZeroSuppresionStream(const TRestRawZeroSuppresionKernel::Parameters& parameters,
+                                          size_t capacity = 1 << 16);
+};
+#endif
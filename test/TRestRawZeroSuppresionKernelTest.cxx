@@ -0,0 +1,198 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// This test checks that the zero suppression of
+/// TRestRawZeroSuppresionKernel is equivalent to the floating-point
+/// semantics of the legacy process, kept at FindPointsReference. Random
+/// channels, with pulses, flat tails and random parameters, are processed
+/// by the generic FindPoints, and by ProcessChannel with and without the
+/// compile-time specializations, for every instruction set supported by
+/// the CPU running it. The points found must be exactly the same.
+///
+/// Half of the channels have kFixedSamples samples, and the number of
+/// points over threshold covers every specialization, so that each
+/// FindPointsImpl<NWords, NPointsOver> is exercised.
+///
+/// A fixed channel is also checked against the points that the legacy
+/// TRestRawSignal::InitializePointsOverThreshold keeps for it, worked out
+/// by hand. Its first pulse has a population deviation of one baseline
+/// sigma, below the signal threshold of 1.1, and is rejected, while its
+/// second pulse, with a deviation of two sigmas, is kept.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// <hr>
+///
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "TRestRawZeroSuppresionKernel.h"
+#include "TRestRawZeroSuppresionSIMD.h"
+
+typedef TRestRawZeroSuppresionKernel Kernel;
+typedef TRestRawZeroSuppresionSIMD SIMD;
+
+namespace {
+
+constexpr Int_t kIterations = 4000;
+
+std::mt19937 gRandom(2016);
+
+/// Returns the samples of a channel with gaussian noise, some exponential pulses and flat tails
+std::vector<Short_t> RandomChannel(Int_t nSamples) {
+    std::normal_distribution<Double_t> noise(250, 1 + gRandom() % 20);
+    std::vector<Short_t> samples(nSamples);
+    for (auto& sample : samples) sample = (Short_t)noise(gRandom);
+
+    for (Int_t n = gRandom() % 5; n > 0; n--) {
+        const Int_t start = gRandom() % nSamples;
+        const Double_t amplitude = 50 + gRandom() % 2000;
+        const Double_t width = 5 + gRandom() % 60;
+        for (Int_t i = start; i < nSamples && i < start + 4 * width; i++)
+            samples[i] += (Short_t)(amplitude * std::exp(-(i - start) / width));
+        if (gRandom() % 3 == 0)
+            for (Int_t i = start; i < nSamples && i < start + 80; i++) samples[i] = samples[start];
+    }
+    return samples;
+}
+
+Kernel::Parameters RandomParameters(Int_t nSamples) {
+    Kernel::Parameters parameters;
+    parameters.fBaseLineStart = gRandom() % 20;
+    parameters.fBaseLineEnd = parameters.fBaseLineStart + gRandom() % 100;
+    parameters.fIntegralStart = gRandom() % 30;
+    parameters.fIntegralEnd = (Int_t)(gRandom() % (nSamples + 50)) - 10;
+    parameters.fPointThreshold = (gRandom() % 60) / 10.;
+    parameters.fSignalThreshold = (gRandom() % 60) / 10.;
+    parameters.fNPointsOverThreshold = gRandom() % (Kernel::kMaxFixedPointsOver + 3);
+    parameters.fNPointsFlatThreshold = (Int_t)(gRandom() % 20) - 2;
+    return parameters;
+}
+
+Bool_t Equal(const std::vector<Kernel::Point>& points, const Kernel::Point* data, Int_t size) {
+    if ((Int_t)points.size() != size) return false;
+    for (Int_t p = 0; p < size; p++)
+        if (points[p].fBin != data[p].fBin || points[p].fData != data[p].fData) return false;
+    return true;
+}
+
+/// Returns the points kept for a channel, processed as the legacy algorithm did. The baseline, taken
+/// from bins [0, 20) alternating 0 and 2, is 1 with a sigma of 1, so the pulses at bins 30 and 40,
+/// (11, 13, 11, 13) and (11, 15, 11, 15), have a population deviation of 1 and 2 sigmas. With a
+/// signal threshold of 1.1, the first pulse is rejected, and it would be kept with TMath::StdDev.
+Int_t CheckLegacyChannel() {
+    std::vector<Short_t> samples(64, 1);
+    for (Int_t i = 0; i < 20; i++) samples[i] = i % 2 ? 2 : 0;
+    const Short_t pulses[] = {11, 13, 11, 13, 0, 0, 0, 0, 0, 0, 11, 15, 11, 15};
+    for (Int_t i = 0; i < 14; i++)
+        if (pulses[i] > 0) samples[30 + i] = pulses[i];
+
+    Kernel::Parameters parameters;
+    parameters.fBaseLineStart = 0;
+    parameters.fBaseLineEnd = 20;
+    parameters.fIntegralStart = 20;
+    parameters.fIntegralEnd = 0;
+    parameters.fPointThreshold = 3;
+    parameters.fSignalThreshold = 1.1;
+    parameters.fNPointsOverThreshold = 3;
+    parameters.fNPointsFlatThreshold = 10;
+    Kernel kernel(parameters);
+
+    const Kernel::Point legacy[] = {{40, 10}, {41, 14}, {42, 10}, {43, 14}};
+
+    Int_t failures = 0;
+    std::vector<Kernel::Point> points;
+    kernel.FindPointsReference(samples.data(), samples.size(), 1, 1, points);
+    if (!Equal(points, legacy, 4)) failures++;
+
+    points.clear();
+    kernel.ProcessChannel(samples.data(), samples.size(), points);
+    if (!Equal(points, legacy, 4)) failures++;
+
+    if (failures > 0) printf("The legacy channel gives %zu points instead of 4\n", points.size());
+    return failures;
+}
+
+}  // namespace
+
+int main() {
+    Int_t failures = 0;
+    const Int_t supported = (Int_t)SIMD::GetSupportedInstructionSet();
+    for (Int_t instructionSet = 0; instructionSet <= supported; instructionSet++) {
+        SIMD::SetInstructionSet((SIMD::InstructionSet)instructionSet);
+
+        Int_t generic = 0, specialized = 0, unspecialized = 0;
+        Int_t nSpecialized[Kernel::kMaxFixedPointsOver + 1] = {};
+        Long64_t nPoints = 0;
+        for (Int_t it = 0; it < kIterations; it++) {
+            const Int_t nSamples = gRandom() % 2 ? Kernel::kFixedSamples : 64 + gRandom() % 600;
+            const std::vector<Short_t> samples = RandomChannel(nSamples);
+            Kernel kernel(RandomParameters(nSamples));
+
+            // The reference takes the baseline from the scalar implementation
+            const Kernel::Parameters& parameters = kernel.GetParameters();
+            const Int_t from = std::max(parameters.fBaseLineStart, 0);
+            const Int_t to = std::min(parameters.fBaseLineEnd, nSamples);
+            Double_t baseLine, baseLineSigma;
+            SIMD::BaseLineScalar(samples.data(), nSamples, 1, from, to, &baseLine, &baseLineSigma);
+
+            std::vector<Kernel::Point> reference;
+            kernel.FindPointsReference(samples.data(), nSamples, baseLine, baseLineSigma, reference);
+            nPoints += reference.size();
+
+            Kernel::Workspace workspace;
+            Kernel::Points points;
+            kernel.FindPoints(samples.data(), nSamples, baseLine, baseLineSigma, points, workspace);
+            if (!Equal(reference, points.fData, points.fSize)) generic++;
+
+            std::vector<Kernel::Point> channelPoints;
+            kernel.ProcessChannel(samples.data(), nSamples, channelPoints);
+            if (!Equal(reference, channelPoints.data(), channelPoints.size())) specialized++;
+            if (kernel.IsSpecialized() && nSamples == Kernel::kFixedSamples)
+                nSpecialized[std::max(parameters.fNPointsOverThreshold, 1)]++;
+
+            kernel.SetSpecialization(false);
+            channelPoints.clear();
+            kernel.ProcessChannel(samples.data(), nSamples, channelPoints);
+            if (!Equal(reference, channelPoints.data(), channelPoints.size())) unspecialized++;
+        }
+
+        printf("%-8s %lld points. FindPoints: %d, specialized: %d, unspecialized: %d differences\n",
+               SIMD::GetInstructionSetName(SIMD::GetInstructionSet()).c_str(), nPoints, generic, specialized,
+               unspecialized);
+        failures += generic + specialized + unspecialized + CheckLegacyChannel();
+
+        for (Int_t n = 1; n <= Kernel::kMaxFixedPointsOver; n++) {
+            if (nSpecialized[n] > 0) continue;
+            printf("FindPointsImpl<%d, %d> was not exercised\n", Kernel::kFixedSamples / 64, n);
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// This test checks that each vectorized building block of
+/// TRestRawZeroSuppresionSIMD gives exactly the same result as its scalar
+/// reference, for every instruction set supported by the CPU running it.
+/// The samples are random, including the extreme values of the 16-bit
+/// range, and so are the windows, the thresholds and the limits, including
+/// the ones outside the range of the samples.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// <hr>
+///
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "TRestRawZeroSuppresionSIMD.h"
+
+typedef TRestRawZeroSuppresionSIMD SIMD;
+
+namespace {
+
+constexpr Int_t kIterations = 1000;
+
+std::mt19937 gRandom(2016);
+
+/// Returns `n` random samples, with some of them at the limits of the 16-bit range
+std::vector<Short_t> RandomSamples(size_t n) {
+    std::vector<Short_t> samples(n);
+    std::normal_distribution<Double_t> noise(std::uniform_int_distribution<Int_t>(-1000, 1000)(gRandom),
+                                             1 + gRandom() % 50);
+    for (auto& sample : samples) {
+        switch (gRandom() % 64) {
+            case 0:
+                sample = -32768;
+                break;
+            case 1:
+                sample = 32767;
+                break;
+            case 2:
+                sample = (Short_t)gRandom();
+                break;
+            default:
+                sample = (Short_t)noise(gRandom);
+        }
+    }
+    // Flat stretches, so that the differences within a small limit are also exercised
+    for (Int_t stretch = gRandom() % 4; stretch > 0; stretch--) {
+        const size_t start = gRandom() % samples.size();
+        const size_t end = std::min(samples.size(), start + gRandom() % 100);
+        for (size_t i = start; i < end; i++) samples[i] = samples[start] + (Short_t)(gRandom() % 3);
+    }
+    return samples;
+}
+
+/// Returns a random threshold or limit around `value`, or outside the 16-bit range
+Int_t RandomThreshold(Int_t value) {
+    static const Int_t extremes[] = {-70000, -32769, -32768, -1, 0, 32767, 65535, 70000};
+    if (gRandom() % 8 == 0) return extremes[gRandom() % 8];
+    return value + (Int_t)(gRandom() % 200) - 100;
+}
+
+Int_t TestBaseLine() {
+    Int_t failures = 0;
+    for (Int_t it = 0; it < kIterations; it++) {
+        const size_t stride = 1 + gRandom() % 700;
+        const size_t nChannels = 1 + gRandom() % 70;
+        const std::vector<Short_t> data = RandomSamples(stride * nChannels);
+        const Int_t from = gRandom() % stride;
+        const Int_t to = (Int_t)(gRandom() % (stride + 1));
+
+        std::vector<Double_t> baseLine(nChannels), baseLineSigma(nChannels);
+        std::vector<Double_t> reference(nChannels), referenceSigma(nChannels);
+        SIMD::BaseLine(data.data(), stride, nChannels, from, to, baseLine.data(), baseLineSigma.data());
+        SIMD::BaseLineScalar(data.data(), stride, nChannels, from, to, reference.data(),
+                             referenceSigma.data());
+        if (baseLine != reference || baseLineSigma != referenceSigma) failures++;
+    }
+
+    // A window longer than the vectorized versions accept falls back to the scalar reference
+    const size_t nSamples = 70000;
+    const std::vector<Short_t> data = RandomSamples(nSamples);
+    Double_t baseLine, baseLineSigma, reference, referenceSigma;
+    SIMD::BaseLine(data.data(), nSamples, 1, 0, nSamples, &baseLine, &baseLineSigma);
+    SIMD::BaseLineScalar(data.data(), nSamples, 1, 0, nSamples, &reference, &referenceSigma);
+    if (baseLine != reference || baseLineSigma != referenceSigma) failures++;
+    return failures;
+}
+
+Int_t TestOverThresholdMask() {
+    Int_t failures = 0;
+    for (Int_t it = 0; it < kIterations; it++) {
+        const Int_t nSamples = 1 + gRandom() % 1100;
+        const std::vector<Short_t> samples = RandomSamples(nSamples);
+        const Int_t threshold = RandomThreshold(samples[gRandom() % nSamples]);
+
+        const Int_t nWords = (nSamples + 63) / 64;
+        std::vector<ULong64_t> mask(nWords, ~0ULL), reference(nWords);
+        SIMD::OverThresholdMask(samples.data(), nSamples, threshold, mask.data());
+        SIMD::OverThresholdMaskScalar(samples.data(), nSamples, threshold, reference.data());
+        if (mask != reference) failures++;
+    }
+    return failures;
+}
+
+Int_t TestFlatMask() {
+    Int_t failures = 0;
+    for (Int_t it = 0; it < kIterations; it++) {
+        const Int_t nSamples = 1 + gRandom() % 1100;
+        const std::vector<Short_t> samples = RandomSamples(nSamples);
+        const Int_t limit = RandomThreshold(gRandom() % 20);
+
+        const Int_t nWords = (nSamples + 63) / 64;
+        std::vector<ULong64_t> mask(nWords, ~0ULL), reference(nWords);
+        SIMD::FlatMask(samples.data(), nSamples, limit, mask.data());
+        SIMD::FlatMaskScalar(samples.data(), nSamples, limit, reference.data());
+        if (mask != reference) failures++;
+    }
+    return failures;
+}
+
+}  // namespace
+
+int main() {
+    Int_t failures = 0;
+    const Int_t supported = (Int_t)SIMD::GetSupportedInstructionSet();
+    for (Int_t instructionSet = 0; instructionSet <= supported; instructionSet++) {
+        SIMD::SetInstructionSet((SIMD::InstructionSet)instructionSet);
+        const std::string name = SIMD::GetInstructionSetName(SIMD::GetInstructionSet());
+
+        const Int_t baseLine = TestBaseLine();
+        const Int_t overThreshold = TestOverThresholdMask();
+        const Int_t flat = TestFlatMask();
+        printf("%-8s BaseLine: %d, OverThresholdMask: %d, FlatMask: %d differences\n", name.c_str(),
+               baseLine, overThreshold, flat);
+        failures += baseLine + overThreshold + flat;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,178 @@
+/*************************************************************************
+ * This file is part of the REST software framework.                     *
+ *                                                                       *
+ * Copyright (C) 2016 GIFNA/TREX (University of Zaragoza)                *
+ * For more information see http://gifna.unizar.es/trex                  *
+ *                                                                       *
+ * REST is free software: you can redistribute it and/or modify          *
+ * it under the terms of the GNU General Public License as published by  *
+ * the Free Software Foundation, either version 3 of the License, or     *
+ * (at your option) any later version.                                   *
+ *                                                                       *
+ * REST is distributed in the hope that it will be useful,               *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the          *
+ * GNU General Public License for more details.                          *
+ *                                                                       *
+ * You should have a copy of the GNU General Public License along with   *
+ * REST in $REST_PATH/LICENSE.                                           *
+ * If not, see http://www.gnu.org/licenses/.                             *
+ * For the list of contributors see $REST_PATH/CREDITS.                  *
+ *************************************************************************/
+
+//////////////////////////////////////////////////////////////////////////
+/// This test checks that TRestRawZeroSuppresionStream emits exactly the
+/// points found by TRestRawZeroSuppresionKernel::ProcessChannel. Random
+/// channels are split in random pieces given to Push, and the output is a
+/// small ring buffer, so that it is often full. The points are taken by
+/// the same thread that pushes the samples, and also by a second thread.
+///
+///--------------------------------------------------------------------------
+///
+/// RESTsoft - Software for Rare Event Searches with TPCs
+///
+/// <hr>
+///
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "TRestRawZeroSuppresionKernel.h"
+#include "TRestRawZeroSuppresionStream.h"
+
+typedef TRestRawZeroSuppresionKernel Kernel;
+typedef TRestRawZeroSuppresionStream Stream;
+
+namespace {
+
+constexpr Int_t kIterations = 2000;
+
+std::mt19937 gRandom(2016);
+
+/// Returns the samples of a channel with gaussian noise, some exponential pulses and flat tails
+std::vector<Short_t> RandomChannel(Int_t nSamples) {
+    std::normal_distribution<Double_t> noise(250, 1 + gRandom() % 20);
+    std::vector<Short_t> samples(nSamples);
+    for (auto& sample : samples) sample = (Short_t)noise(gRandom);
+
+    for (Int_t n = gRandom() % 5; n > 0; n--) {
+        const Int_t start = gRandom() % nSamples;
+        const Double_t amplitude = 50 + gRandom() % 2000;
+        const Double_t width = 5 + gRandom() % 60;
+        for (Int_t i = start; i < nSamples && i < start + 4 * width; i++)
+            samples[i] += (Short_t)(amplitude * std::exp(-(i - start) / width));
+        if (gRandom() % 3 == 0)
+            for (Int_t i = start; i < nSamples && i < start + 80; i++) samples[i] = samples[start];
+    }
+    return samples;
+}
+
+Kernel::Parameters RandomParameters(Int_t nSamples) {
+    Kernel::Parameters parameters;
+    parameters.fBaseLineStart = gRandom() % 20;
+    parameters.fBaseLineEnd = parameters.fBaseLineStart + gRandom() % 100;
+    parameters.fIntegralStart = gRandom() % 30;
+    parameters.fIntegralEnd = (Int_t)(gRandom() % (nSamples + 50)) - 10;
+    parameters.fPointThreshold = (gRandom() % 60) / 10.;
+    parameters.fSignalThreshold = (gRandom() % 60) / 10.;
+    parameters.fNPointsOverThreshold = gRandom() % 10;
+    parameters.fNPointsFlatThreshold = (Int_t)(gRandom() % 20) - 2;
+    parameters.fSampling = 1 + gRandom() % 100 / 10.;
+    return parameters;
+}
+
+Bool_t Equal(const std::vector<Kernel::Point>& reference, const std::vector<Stream::Point>& points,
+             Int_t signalID, Double_t sampling) {
+    if (reference.size() != points.size()) return false;
+    for (size_t p = 0; p < points.size(); p++)
+        if (points[p].fSignalID != signalID || points[p].fTime != reference[p].fBin * sampling ||
+            points[p].fData != reference[p].fData)
+            return false;
+    return true;
+}
+
+/// It gives the samples to the stream in random pieces, taking the points in the same thread
+std::vector<Stream::Point> StreamSingleThread(Stream& stream, Int_t signalID,
+                                              const std::vector<Short_t>& samples) {
+    std::vector<Stream::Point> points;
+    Stream::Point point;
+
+    stream.BeginChannel(signalID);
+    for (Int_t n = 0; n < (Int_t)samples.size();) {
+        const Int_t size = std::min<Int_t>(1 + gRandom() % 100, samples.size() - n);
+        n += stream.Push(samples.data() + n, size);
+        while (stream.Pop(point)) points.push_back(point);
+    }
+
+    for (Bool_t flushed = stream.EndChannel();; flushed = stream.Flush()) {
+        while (stream.Pop(point)) points.push_back(point);
+        if (flushed) break;
+    }
+    return points;
+}
+
+/// It gives the samples to the stream in random pieces, while another thread takes the points
+std::vector<Stream::Point> StreamTwoThreads(Stream& stream, Int_t signalID,
+                                            const std::vector<Short_t>& samples) {
+    std::vector<Stream::Point> points;
+    std::atomic<Bool_t> done{false};
+    std::thread consumer([&]() {
+        Stream::Point point;
+        while (!done.load(std::memory_order_acquire)) {
+            while (stream.Pop(point)) points.push_back(point);
+            std::this_thread::yield();
+        }
+        while (stream.Pop(point)) points.push_back(point);
+    });
+
+    std::vector<Int_t> sizes;
+    for (Int_t n = 0; n < (Int_t)samples.size(); n += sizes.back())
+        sizes.push_back(std::min<Int_t>(1 + gRandom() % 100, samples.size() - n));
+
+    stream.BeginChannel(signalID);
+    Int_t n = 0;
+    for (const Int_t size : sizes) {
+        for (Int_t end = n + size; n < end;) {
+            const Int_t consumed = stream.Push(samples.data() + n, end - n);
+            if (consumed == 0) std::this_thread::yield();
+            n += consumed;
+        }
+    }
+    while (!stream.EndChannel()) std::this_thread::yield();
+
+    done.store(true, std::memory_order_release);
+    consumer.join();
+    return points;
+}
+
+}  // namespace
+
+int main() {
+    Int_t singleThread = 0, twoThreads = 0;
+    Long64_t nPoints = 0;
+    for (Int_t it = 0; it < kIterations; it++) {
+        const Int_t nSamples = 64 + gRandom() % 600;
+        const std::vector<Short_t> samples = RandomChannel(nSamples);
+        const Kernel::Parameters parameters = RandomParameters(nSamples);
+
+        Kernel kernel(parameters);
+        std::vector<Kernel::Point> reference;
+        kernel.ProcessChannel(samples.data(), nSamples, reference);
+        nPoints += reference.size();
+
+        Stream stream(parameters, 1 + gRandom() % 64);
+        if (!Equal(reference, StreamSingleThread(stream, it, samples), it, parameters.fSampling))
+            singleThread++;
+        if (!Equal(reference, StreamTwoThreads(stream, it, samples), it, parameters.fSampling))
+            twoThreads++;
+    }
+
+    printf("%lld points. Single thread: %d, two threads: %d differences\n", nPoints, singleThread,
+           twoThreads);
+    return singleThread + twoThreads == 0 ? 0 : 1;
+}